@@ -0,0 +1,110 @@
+//================================================================================
+
+// Integration benchmark
+// Compares the per-particle postUpdate loop against the packed column kernels.
+// Usage: turbine-bench-integrate [frames]
+
+//================================================================================
+
+#include "global.h"
+
+#include "particle-integrate.h"
+#include "particle-store.h"
+
+//================================================================================
+
+using namespace Gfx::Particle;
+
+//--------------------------------------------------------------------------------
+
+constexpr float delta = 1.f / 60.f;
+
+//--------------------------------------------------------------------------------
+
+void fill( PropertyColumns& columns, size_t count ) {
+	columns.resize( count );
+	for( size_t i = 0u; i < count; ++i ) {
+		const float f = float( i % 1000u ) * 0.001f;
+
+		columns.positionX[ i ]	   = f * 100.f;
+		columns.positionY[ i ]	   = f * -50.f;
+		columns.velocityX[ i ]	   = 1.f + f;
+		columns.velocityY[ i ]	   = 2.f - f;
+		columns.accelerationX[ i ] = f;
+		columns.accelerationY[ i ] = -9.8f;
+		columns.rotation[ i ]	   = f * 360.f;
+		columns.spin[ i ]		   = 90.f * f;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+// The loop postUpdate ran before the kernels, one particle at a time
+void loop( PropertyColumns& current, PropertyColumns& frame, size_t count, float dt ) {
+	for( size_t id = 0u; id < count; ++id ) {
+		current.velocityX[ id ] += frame.accelerationX[ id ] * dt;
+		current.velocityY[ id ] += frame.accelerationY[ id ] * dt;
+		frame.velocityX[ id ] += frame.accelerationX[ id ] * dt;
+		frame.velocityY[ id ] += frame.accelerationY[ id ] * dt;
+
+		current.positionX[ id ] += frame.velocityX[ id ] * dt;
+		current.positionY[ id ] += frame.velocityY[ id ] * dt;
+		frame.positionX[ id ] += frame.velocityX[ id ] * dt;
+		frame.positionY[ id ] += frame.velocityY[ id ] * dt;
+
+		current.rotation[ id ] += frame.spin[ id ] * dt;
+		frame.rotation[ id ] += frame.spin[ id ] * dt;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+template< class Func >
+double measure( size_t count, int frames, Func func ) {
+	PropertyColumns current;
+	PropertyColumns frame;
+	fill( current, count );
+	fill( frame, count );
+
+	// Warm the cache and the branch predictor
+	func( current, frame, count, delta );
+
+	const auto start = high_resolution_clock::now();
+	for( int i = 0; i < frames; ++i )
+		func( current, frame, count, delta );
+	const auto end = high_resolution_clock::now();
+
+	// Keep the result alive
+	volatile float sink = current.positionX[ count / 2u ] + frame.rotation[ count / 2u ];
+	( void )sink;
+
+	return duration_cast< nanoseconds >( end - start ).count() / 1000.0 / frames;
+}
+
+//================================================================================
+
+int main( int argc, char** argv ) {
+	const int frames = argc > 1 ? std::max( 1, std::atoi( argv[ 1 ] ) ) : 1000;
+	const Integrate::Kernel supported = Integrate::getSupported();
+
+	printf( "Frames: %i, supported kernel: %s\n\n", frames, Integrate::getName( supported ).c_str() );
+	printf( "%10s %10s %12s %10s\n", "Particles", "Kernel", "us / frame", "Speedup" );
+
+	for( size_t count : { 10000u, 50000u, 100000u } ) {
+		const double baseline = measure( count, frames, loop );
+		printf( "%10zu %10s %12.2f %10s\n", count, "Loop", baseline, "-" );
+
+		for( int k = 0; k <= int( supported ); ++k ) {
+			const Integrate::Kernel kernel = Integrate::Kernel( k );
+			const double time			   = measure( count, frames,
+										  [kernel]( PropertyColumns& current, PropertyColumns& frame, size_t n, float dt ) {
+											  Integrate::run( kernel, current, frame, n, dt );
+										  } );
+			printf( "%10zu %10s %12.2f %9.2fx\n", count, Integrate::getName( kernel ).c_str(), time, baseline / time );
+		}
+	}
+
+	return 0;
+}
+
+//================================================================================
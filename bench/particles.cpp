@@ -0,0 +1,294 @@
+//================================================================================
+
+// Particle engine benchmark
+// Runs Particle::Manager without a window over a few representative patterns
+// and reports ns / particle for spawn, update, postUpdate and vertex generation.
+// Atlas textures still need a GL context, SFML creates a hidden one.
+// Usage: turbine-bench [frames] [output.json]
+
+//================================================================================
+
+#include "global.h"
+
+#include "jobs.h"
+#include "json.h"
+#include "random.h"
+
+#include "particle-affector-manager.h"
+#include "particle-affector.h"
+#include "particle-integrate.h"
+#include "particle-loader.h"
+#include "particle-manager.h"
+#include "particle.h"
+
+//================================================================================
+
+using namespace Gfx::Particle;
+
+//--------------------------------------------------------------------------------
+
+constexpr float delta = 1.f / 60.f;
+constexpr uint64_t seed = 1u;
+
+// Patterns are written here and loaded back through the Loader
+const string folder = "./Data/Bench/";
+
+// Large enough that culling keeps every particle
+const sf::View view( sf::FloatRect( -4000.f, -4000.f, 8000.f, 8000.f ) );
+
+//--------------------------------------------------------------------------------
+
+struct Result {
+	string pattern;
+	size_t particles{ 0u };
+
+	// ns / particle
+	double spawn{ 0.0 };
+	double update{ 0.0 };
+	double postUpdate{ 0.0 };
+	double vertices{ 0.0 };
+};
+
+//================================================================================
+
+template< class T >
+Math::ValueSet< T > range( T min, T max ) {
+	Math::ValueSet< T > out( min );
+	out.max	   = max;
+	out.random = true;
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+ParticlePattern makePattern( const string& name, int number, int lifetime ) {
+	ParticlePattern out;
+	out.name	 = name;
+	out.number	 = Math::ValueSet< int >( number );
+	out.lifetime = Math::ValueSet< int >( lifetime );
+	out.scale	 = Math::ValueSet< Math::Vec2 >( Math::Vec2( 8.f, 8.f ) );
+	out.rotation = range( 0.f, 360.f );
+	out.spin	 = range( -90.f, 90.f );
+
+	out.position.type		  = Math::Position::Type::Circle;
+	out.position.value.circle = Math::CirclePosition();
+	out.position.value.circle.maxRadius = Math::ValueSet< float >( 200.f );
+	out.position.value.circle.maxAngle	= Math::ValueSet< float >( 360.f );
+
+	out.velocity.type		 = Math::Velocity::Type::ByAngle;
+	out.velocity.value.angle = Math::AngleVelocity();
+	out.velocity.value.angle.angle = range( 0.f, 360.f );
+	out.velocity.value.angle.power = range( 10.f, 100.f );
+
+	out.acceleration.type		 = Math::Velocity::Type::ByValue;
+	out.acceleration.value.value = Math::ValueVelocity();
+	out.acceleration.value.value.value = Math::ValueSet< Math::Vec2 >( Math::Vec2( 0.f, 9.8f ) );
+
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+ParticleEmitter makeEmitter( EmitterType type, float rate, vector< string > patterns, bool onDeath = false ) {
+	ParticleEmitter out;
+	out.type	 = type;
+	out.rate	 = Math::ValueSet< float >( rate );
+	out.patterns = patterns;
+	out.onDeath	 = onDeath;
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+string save( ParticlePattern& pattern ) {
+	const string path = folder + pattern.name + ".bullet";
+	json::save( [&pattern] { return pattern.getValue(); }, path );
+	return path;
+}
+
+//--------------------------------------------------------------------------------
+
+// Root pattern paths by name. Lifetimes are long enough that the count stays put
+// while measuring, except for the emitted children.
+vector< pair< string, string > > makePatterns() {
+	vector< pair< string, string > > out;
+
+	ParticlePattern plain = makePattern( "plain", 64, 60000 );
+	out.push_back( { "plain", save( plain ) } );
+
+	// Every affector type
+	ParticlePattern affected = makePattern( "affectors", 64, 60000 );
+	affected.affectors = {
+		make_shared< Affector::RotateToVelocityAffectorCreator >(),
+		make_shared< Affector::SinPositionAffectorCreator >(),
+		make_shared< Affector::SinVelocityAffectorCreator >(),
+		make_shared< Affector::SinAlphaAffectorCreator >(),
+		make_shared< Affector::SinColorAffectorCreator >(),
+		make_shared< Affector::SinSpinAffectorCreator >(),
+		make_shared< Affector::FadeVelocityAffectorCreator >(),
+		make_shared< Affector::FadeScaleAffectorCreator >(),
+		make_shared< Affector::FadeAlphaAffectorCreator >(),
+		make_shared< Affector::FadeColorAffectorCreator >(),
+	};
+	out.push_back( { "affectors", save( affected ) } );
+
+	// Ambient smoke, evaluated from age instead of simulated
+	ParticlePattern smoke = makePattern( "analytic", 64, 60000 );
+	smoke.analytic	= true;
+	smoke.affectors = {
+		make_shared< Affector::FadeScaleAffectorCreator >(),
+		make_shared< Affector::FadeAlphaAffectorCreator >(),
+		make_shared< Affector::SinPositionAffectorCreator >(),
+	};
+	out.push_back( { "analytic", save( smoke ) } );
+
+	// Nested emitters of every type, with attached children
+	ParticlePattern childA = makePattern( "child-a", 1, 250 );
+	childA.inheritance.position		   = Inheritance::Value( InheritanceType::Offset );
+	childA.inheritance.position.attach = true;
+	childA.affectors.push_back( make_shared< Affector::FadeAlphaAffectorCreator >() );
+
+	ParticlePattern childB = makePattern( "child-b", 2, 250 );
+	childB.inheritance.color		   = Inheritance::Value( InheritanceType::Copy );
+	childB.inheritance.color.attach	   = true;
+	childB.inheritance.velocity		   = Inheritance::Value( InheritanceType::Offset );
+	childB.inheritance.velocity.attach = true;
+	childB.affectors.push_back( make_shared< Affector::SinPositionAffectorCreator >() );
+
+	const vector< string > children{ save( childA ), save( childB ) };
+
+	ParticlePattern nested = makePattern( "nested", 16, 60000 );
+	nested.emitters = {
+		makeEmitter( EmitterType::Set, 1.f, children ),
+		makeEmitter( EmitterType::Random, 1.f, children ),
+		makeEmitter( EmitterType::Sequence, 1.f, children ),
+		makeEmitter( EmitterType::Set, 0.f, { children.front() }, true ),
+	};
+	out.push_back( { "nested", save( nested ) } );
+
+	return out;
+}
+
+//================================================================================
+
+Result measure( const string& name, const CompiledPattern& pattern, size_t count, int frames ) {
+	using clock = high_resolution_clock;
+
+	Result out;
+	out.pattern = name;
+
+	Manager::clearAll();
+	Random::setSeed( seed );
+
+	// Spawn
+	const auto spawnStart = clock::now();
+	while( Manager::getParticleCount() < count && !Manager::spawnParticle( pattern ).empty() ) {}
+	const auto spawnEnd = clock::now();
+
+	out.particles = Manager::getParticleCount();
+	out.spawn	  = double( duration_cast< nanoseconds >( spawnEnd - spawnStart ).count() ) / double( std::max( out.particles, size_t( 1u ) ) );
+
+	// Frames, counts change as emitters spawn and children die
+	const sf::Time time = sf::seconds( delta );
+	nanoseconds update{ 0 };
+	nanoseconds postUpdate{ 0 };
+	nanoseconds vertices{ 0 };
+	size_t updated	  = 0u;
+	size_t integrated = 0u;
+
+	for( int i = 0; i < frames; ++i ) {
+		updated += Manager::getParticleCount();
+		const auto updateStart = clock::now();
+		Manager::update( time );
+		const auto updateEnd = clock::now();
+
+		integrated += Manager::getParticleCount();
+		Manager::postUpdate( time );
+		const auto postUpdateEnd = clock::now();
+
+		Manager::buildVertices( view );
+		const auto verticesEnd = clock::now();
+
+		update += duration_cast< nanoseconds >( updateEnd - updateStart );
+		postUpdate += duration_cast< nanoseconds >( postUpdateEnd - updateEnd );
+		vertices += duration_cast< nanoseconds >( verticesEnd - postUpdateEnd );
+	}
+
+	out.update	   = double( update.count() ) / double( std::max( updated, size_t( 1u ) ) );
+	out.postUpdate = double( postUpdate.count() ) / double( std::max( integrated, size_t( 1u ) ) );
+	out.vertices   = double( vertices.count() ) / double( std::max( integrated, size_t( 1u ) ) );
+
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+rapidjson::Value getValue( const vector< Result >& results, int frames ) {
+	rapidjson::Value out;
+	out.SetObject();
+
+	out.AddMember( "frames", json::getValue( frames ), json::getAllocator() );
+	out.AddMember( "threads", json::getValue( Jobs::getThreadCount() ), json::getAllocator() );
+	out.AddMember( "integration", json::getValue( Integrate::getName( Integrate::getKernel() ) ), json::getAllocator() );
+
+	rapidjson::Value vResults;
+	vResults.SetArray();
+	for( const Result& result : results ) {
+		rapidjson::Value v;
+		v.SetObject();
+		v.AddMember( "pattern", json::getValue( result.pattern ), json::getAllocator() );
+		v.AddMember( "particles", json::getValue( result.particles ), json::getAllocator() );
+		v.AddMember( "spawn", json::getValue( float( result.spawn ) ), json::getAllocator() );
+		v.AddMember( "update", json::getValue( float( result.update ) ), json::getAllocator() );
+		v.AddMember( "postUpdate", json::getValue( float( result.postUpdate ) ), json::getAllocator() );
+		v.AddMember( "vertices", json::getValue( float( result.vertices ) ), json::getAllocator() );
+		vResults.PushBack( v, json::getAllocator() );
+	}
+	out.AddMember( "results", vResults, json::getAllocator() );
+
+	return out;
+}
+
+//================================================================================
+
+int main( int argc, char** argv ) {
+	const int frames	 = argc > 1 ? std::max( 1, std::atoi( argv[ 1 ] ) ) : 120;
+	const string output = argc > 2 ? argv[ 2 ] : folder + "results.json";
+
+	// What System::init does, minus the window and the debug UI
+	Jobs::init();
+	Manager::init();
+	Affector::init();
+
+	vector< Result > results;
+
+	printf( "Frames: %i, threads: %zu\n\n", frames, Jobs::getThreadCount() );
+	printf( "%10s %10s %10s %10s %12s %10s\n", "Pattern", "Particles", "Spawn", "Update", "Post Update", "Vertices" );
+
+	for( const auto& [name, path] : makePatterns() ) {
+		const CompiledPattern* pattern = Loader::get( path );
+
+		for( size_t count : { 1000u, 10000u, 30000u } ) {
+			const Result result = measure( name, *pattern, count, frames );
+			printf( "%10s %10zu %10.1f %10.1f %12.1f %10.1f\n",
+					name.c_str(),
+					result.particles,
+					result.spawn,
+					result.update,
+					result.postUpdate,
+					result.vertices );
+			results.push_back( result );
+		}
+	}
+
+	printf( "\nns / particle, written to %s\n", output.c_str() );
+	const bool saved = json::save( [&results, frames] { return getValue( results, frames ); }, output );
+
+	Manager::shutdown();
+	Loader::unload();
+	Jobs::shutdown();
+
+	return saved ? 0 : 1;
+}
+
+//================================================================================
@@ -25,8 +25,8 @@ ParticleEditor::ParticleEditor() {}
 
 ParticleEditor::ParticleEditor( string path ) {
 	json::load(
-		[this]( const rapidjson::Value& value ) {
-			return m_pattern.setValue( value );
+		[this]( json::Stream& in ) {
+			return m_pattern.setValue( in );
 		},
 		path );
 }
@@ -125,7 +125,7 @@ void ParticleEditor::reset() {
 	Gfx::Particle::Manager::clearAll();
 	Gfx::Particle::Loader::unload();
 
-	m_system->getEmitters().clear();
+	m_system->clearEmitters();
 
 	m_emitter.patterns.clear();
 	m_emitter.patterns.push_back( m_pattern );
@@ -226,13 +226,13 @@ void ParticleEditor::save() {
 	strftime( buffer, sizeof( buffer ), "%d-%m-%Y %H:%M:%S", timeinfo );
 	std::string str( buffer );
 
-	if( json::save( [this] { return m_pattern.getValue(); },
-					Folders::Bullets + m_pattern.name + ".bullet" ) )
-		Debug::addMessage(
-			Utils::format( "Saved \"%s\" at %s",
-						   ( Folders::Bullets + m_pattern.name + ".bullet" ).c_str(),
-						   str.c_str() ),
-			DebugType::Info );
+	const string path = Folders::Bullets + m_pattern.name + ".bullet";
+	if( json::save( [this] { return m_pattern.getValue(); }, path ) ) {
+		Debug::addMessage( Utils::format( "Saved \"%s\" at %s", path.c_str(), str.c_str() ), DebugType::Info );
+
+		// Exported alongside so the runtime can skip JSON
+		Gfx::Particle::Loader::saveBinary( m_pattern, Gfx::Particle::Loader::getBinaryPath( path ) );
+	}
 
 	m_unsaved = false;
 	m_saved	  = true;
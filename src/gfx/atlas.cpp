@@ -0,0 +1,152 @@
+//================================================================================
+
+#include "atlas.h"
+
+//--------------------------------------------------------------------------------
+
+#include "debug.h"
+
+//================================================================================
+
+namespace Gfx {
+namespace Atlas {
+
+//--------------------------------------------------------------------------------
+
+// Gap between packed sprites so edge texels never sample a neighbour.
+// Pages aren't smoothed, like the sprite textures they replace.
+constexpr unsigned padding = 1u;
+constexpr unsigned preferredPageSize = 2048u;
+
+//--------------------------------------------------------------------------------
+
+// A row of sprites, as tall as the tallest one in it
+struct Shelf {
+	unsigned y{ 0u };
+	unsigned height{ 0u };
+	unsigned width{ 0u };
+};
+
+struct Page {
+	sf::Texture texture;
+	sf::Vector2u size;
+	vector< Shelf > shelves;
+	unsigned height{ 0u };
+};
+
+//--------------------------------------------------------------------------------
+
+// unique_ptr so textures don't move when pages are added
+vector< unique_ptr< Page > > pages;
+unordered_map< Sprite::ID, Region > regions;
+
+//--------------------------------------------------------------------------------
+
+bool place( Page& page, sf::Vector2u size, sf::Vector2u& position ) {
+	const unsigned width  = size.x + padding;
+	const unsigned height = size.y + padding;
+
+	// Best fit on an existing shelf
+	Shelf* best = nullptr;
+	for( Shelf& shelf : page.shelves ) {
+		if( shelf.height < height || shelf.width + width > page.size.x )
+			continue;
+		if( best == nullptr || shelf.height < best->height )
+			best = &shelf;
+	}
+
+	if( best == nullptr ) {
+		if( page.height + height > page.size.y || width > page.size.x )
+			return false;
+
+		page.shelves.push_back( Shelf{ page.height, height, 0u } );
+		page.height += height;
+		best = &page.shelves.back();
+	}
+
+	position = sf::Vector2u( best->width, best->y );
+	best->width += width;
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+Page& addPage( sf::Vector2u size ) {
+	auto page  = make_unique< Page >();
+	page->size = size;
+
+	if( !page->texture.create( size.x, size.y ) )
+		Debug::addMessage( "Failed to create atlas page", DebugType::Error );
+
+	pages.push_back( std::move( page ) );
+	return *pages.back();
+}
+
+//================================================================================
+
+Region get( Sprite::ID sprite ) {
+	const auto it = regions.find( sprite );
+	if( it != regions.end() )
+		return it->second;
+
+	const sf::Texture& texture = Sprite::get( sprite );
+	const sf::Vector2u size	   = texture.getSize();
+
+	Region region;
+	sf::Vector2u position;
+
+	bool placed = false;
+	for( size_t i = 0u; i < pages.size() && !placed; ++i ) {
+		placed = place( *pages.at( i ), size, position );
+		if( placed )
+			region.page = i;
+	}
+
+	if( !placed ) {
+		const unsigned maxSize = sf::Texture::getMaximumSize();
+		if( size.x > maxSize || size.y > maxSize ) {
+			Debug::addMessage( "Sprite is too big for an atlas page", DebugType::Error );
+			return Region();
+		}
+
+		const unsigned pageSize = std::min( preferredPageSize, maxSize );
+
+		// Sprites bigger than a page get one to themselves, the page stays
+		// within the GPU limit even when that leaves no room for padding
+		Page& page = addPage( sf::Vector2u( std::min( std::max( pageSize, size.x + padding ), maxSize ),
+											std::min( std::max( pageSize, size.y + padding ), maxSize ) ) );
+		region.page = pages.size() - 1u;
+
+		// Nothing to pad against, the sprite fills the page
+		if( !place( page, size, position ) ) {
+			position	= sf::Vector2u( 0u, 0u );
+			page.height = page.size.y;
+		}
+	}
+
+	pages.at( region.page )->texture.update( texture, position.x, position.y );
+	region.texCoords = sf::FloatRect( float( position.x ), float( position.y ), float( size.x ), float( size.y ) );
+
+	regions[ sprite ] = region;
+	return region;
+}
+
+//--------------------------------------------------------------------------------
+
+sf::Texture& getPage( size_t page ) {
+	return pages.at( page )->texture;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t getPageCount() {
+	return pages.size();
+}
+
+//================================================================================
+
+} // Atlas
+} // Gfx
+
+//================================================================================
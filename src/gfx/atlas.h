@@ -0,0 +1,37 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "sprite.h"
+
+//================================================================================
+
+namespace Gfx {
+namespace Atlas {
+
+//--------------------------------------------------------------------------------
+
+// Where a sprite ended up in the atlas, texCoords are in pixels
+struct Region {
+	size_t page{ 0u };
+	sf::FloatRect texCoords;
+};
+
+//--------------------------------------------------------------------------------
+
+// Packs the sprite into an atlas page on first use
+Region get( Sprite::ID sprite );
+
+sf::Texture& getPage( size_t page );
+size_t getPageCount();
+
+//--------------------------------------------------------------------------------
+
+} // Atlas
+} // Gfx
+
+//================================================================================
@@ -0,0 +1,223 @@
+//================================================================================
+
+#include "particle-affector-batch.h"
+
+//--------------------------------------------------------------------------------
+
+#include "jobs.h"
+
+//================================================================================
+
+namespace Gfx::Particle::Affector {
+
+//--------------------------------------------------------------------------------
+
+constexpr size_t chunkSize = 4096u;
+
+Tables tables;
+Tables analyticTables;
+
+//================================================================================
+
+// One loop per type over rows [begin, end)
+
+void run( Table< RotateToVelocityColumns >& table, Store& store, size_t begin, size_t end ) {
+	const RotateToVelocityColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::rotateToVelocity( store, id, c.offset[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< SinPositionColumns >& table, Store& store, size_t begin, size_t end ) {
+	const SinPositionColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::sinPosition( store,
+								 id,
+								 c.period[ i ],
+								 Math::Vec2( c.targetX[ i ], c.targetY[ i ] ),
+								 c.offset[ i ],
+								 c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< SinVelocityColumns >& table, Store& store, size_t begin, size_t end ) {
+	const SinVelocityColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::sinVelocity( store, id, c.period[ i ], c.min[ i ], c.max[ i ], c.offset[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< SinAlphaColumns >& table, Store& store, size_t begin, size_t end ) {
+	const SinAlphaColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::sinAlpha( store, id, c.period[ i ], c.target[ i ], c.offset[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< SinColorColumns >& table, Store& store, size_t begin, size_t end ) {
+	const SinColorColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::sinColor( store,
+							  id,
+							  c.period[ i ],
+							  Math::Color( c.targetR[ i ], c.targetG[ i ], c.targetB[ i ], c.targetA[ i ] ),
+							  c.offset[ i ],
+							  c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< SinSpinColumns >& table, Store& store, size_t begin, size_t end ) {
+	const SinSpinColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::sinSpin( store, id, c.period[ i ], c.min[ i ], c.max[ i ], c.offset[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< FadeVelocityColumns >& table, Store& store, size_t begin, size_t end ) {
+	const FadeVelocityColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::fadeVelocity( store, id, c.start[ i ], c.end[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< FadeScaleColumns >& table, Store& store, size_t begin, size_t end ) {
+	const FadeScaleColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::fadeScale( store, id, c.start[ i ], c.end[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< FadeAlphaColumns >& table, Store& store, size_t begin, size_t end ) {
+	const FadeAlphaColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::fadeAlpha( store, id, c.target[ i ], c.exponent[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Table< FadeColorColumns >& table, Store& store, size_t begin, size_t end ) {
+	const FadeColorColumns& c = table.columns;
+	for( size_t i = begin; i < end; ++i ) {
+		const size_t id = store.resolve( table.particles[ i ] );
+		if( id != Store::none )
+			Kernel::fadeColor( store,
+							   id,
+							   Math::Color( c.targetR[ i ], c.targetG[ i ], c.targetB[ i ], c.targetA[ i ] ),
+							   c.exponent[ i ] );
+	}
+}
+
+//================================================================================
+
+Tables& getTables() {
+	return tables;
+}
+
+//--------------------------------------------------------------------------------
+
+Tables& getAnalyticTables() {
+	return analyticTables;
+}
+
+//--------------------------------------------------------------------------------
+
+TableMark markTables() {
+	TableMark out;
+	tables.forEachLayer( [&out]( auto& table, size_t type, size_t ) { out[ type ].push_back( table.size() ); } );
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+void runTables( Store& store ) {
+	runTables( tables, store );
+}
+
+//--------------------------------------------------------------------------------
+
+void runTables( Tables& tables, Store& store ) {
+	// Layers run one after another, rows of a layer are independent
+	tables.forEach( [&store]( auto& table ) {
+		if( table.size() == 0u )
+			return;
+
+		Jobs::parallelFor( table.size(), chunkSize, [&table, &store]( size_t begin, size_t end ) {
+			run( table, store, begin, end );
+		} );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
+void runTables( Store& store, const TableMark& from ) {
+	tables.forEachLayer( [&store, &from]( auto& table, size_t type, size_t layer ) {
+		// Layers created since the mark start from zero
+		const size_t begin = layer < from[ type ].size() ? from[ type ][ layer ] : 0u;
+		run( table, store, begin, table.size() );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
+void sweepTables( const Store& store ) {
+	sweepTables( tables, store );
+}
+
+//--------------------------------------------------------------------------------
+
+void sweepTables( Tables& tables, const Store& store ) {
+	tables.forEach( [&store]( auto& table ) { table.sweep( store ); } );
+}
+
+//--------------------------------------------------------------------------------
+
+void clearTables() {
+	clearTables( tables );
+}
+
+//--------------------------------------------------------------------------------
+
+void clearTables( Tables& tables ) {
+	tables.forEach( []( auto& table ) { table.clear(); } );
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Affector
+
+//================================================================================
@@ -0,0 +1,375 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include <cmath>
+
+#include "mathtypes.h"
+#include "particle-affector.h"
+#include "particle-store.h"
+
+//================================================================================
+
+// Per-type affector tables.
+// Stateless per-particle affectors don't get an instance each, they add a row
+// to their type's table and every table runs as one tight loop per frame.
+namespace Gfx::Particle::Affector {
+
+//--------------------------------------------------------------------------------
+
+// Kernels shared by the tables and the per-instance affectors
+
+namespace Kernel {
+
+inline float sine( const Store& store, size_t id, float period, float offset ) {
+	const float alpha = ( float )store.frame.duration[ id ].count() / period + offset;
+	return ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
+}
+
+inline float fade( const Store& store, size_t id, float exponent ) {
+	const float alpha
+		= 1.0f - ( ( float )store.frame.remaining[ id ].count() / ( float )store.lifetime[ id ].count() );
+	return powf( alpha, exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+inline void rotateToVelocity( Store& store, size_t id, float offset ) {
+	store.frame.rotation[ id ] = store.frame.getVelocity( id ).angle() + offset;
+}
+
+inline void sinPosition( Store& store, size_t id, float period, Math::Vec2 target, float offset, float exponent ) {
+	const float amp = powf( sine( store, id, period, offset ), exponent );
+	store.frame.positionX[ id ] += Math::mix( 0.f, target.x, amp );
+	store.frame.positionY[ id ] += Math::mix( 0.f, target.y, amp );
+}
+
+inline void sinVelocity( Store& store, size_t id, float period, float min, float max, float offset, float exponent ) {
+	const float amp = Math::mix( min, max, powf( sine( store, id, period, offset ), exponent ) );
+	store.frame.velocityX[ id ] *= amp;
+	store.frame.velocityY[ id ] *= amp;
+}
+
+inline void sinAlpha( Store& store, size_t id, float period, float target, float offset, float exponent ) {
+	if( period == 0.f )
+		return;
+
+	const float amp			 = powf( sine( store, id, period, offset ), exponent );
+	store.frame.colorA[ id ] = Math::mix( store.frame.colorA[ id ], target, amp );
+}
+
+inline void sinColor( Store& store, size_t id, float period, Math::Color target, float offset, float exponent ) {
+	const float amp = powf( sine( store, id, period, offset ), exponent );
+	store.frame.setColor( id, Math::mix( store.frame.getColor( id ), target, amp ) );
+}
+
+inline void sinSpin( Store& store, size_t id, float period, float min, float max, float offset, float exponent ) {
+	store.frame.spin[ id ] *= Math::mix( min, max, powf( sine( store, id, period, offset ), exponent ) );
+}
+
+inline void fadeVelocity( Store& store, size_t id, float start, float end, float exponent ) {
+	const float mul = Math::mix( start, end, fade( store, id, exponent ) );
+	store.frame.velocityX[ id ] *= mul;
+	store.frame.velocityY[ id ] *= mul;
+}
+
+inline void fadeScale( Store& store, size_t id, float start, float end, float exponent ) {
+	const float mul = Math::mix( start, end, fade( store, id, exponent ) );
+	store.frame.scaleX[ id ] *= mul;
+	store.frame.scaleY[ id ] *= mul;
+}
+
+inline void fadeAlpha( Store& store, size_t id, float target, float exponent ) {
+	store.frame.colorA[ id ] = Math::mix( store.frame.colorA[ id ], target, fade( store, id, exponent ) );
+}
+
+inline void fadeColor( Store& store, size_t id, Math::Color target, float exponent ) {
+	const float alpha = fade( store, id, exponent );
+	Math::Color color = Math::mix( store.frame.getColor( id ), target, alpha );
+	color.a			  = Math::mix( color.a, target.a, alpha );
+	store.frame.setColor( id, color );
+}
+
+}	 // namespace Kernel
+
+//================================================================================
+
+// Parameter columns, row i belongs to Table::particles[ i ].
+// type indexes per type arrays like TableMark.
+
+struct RotateToVelocityColumns {
+	static constexpr size_t type = 0u;
+
+	vector< float > offset;
+
+	template< class F >
+	void forEach( F f ) {
+		f( offset );
+	}
+};
+
+//--------------------------------------------------------------------------------
+
+// Period is in microseconds
+struct SinColumns {
+	vector< float > period;
+	vector< float > offset;
+	vector< float > exponent;
+};
+
+struct SinPositionColumns : SinColumns {
+	static constexpr size_t type = 1u;
+
+	vector< float > targetX;
+	vector< float > targetY;
+
+	template< class F >
+	void forEach( F f ) {
+		f( period );
+		f( offset );
+		f( exponent );
+		f( targetX );
+		f( targetY );
+	}
+};
+
+struct SinRangeColumns : SinColumns {
+	vector< float > min;
+	vector< float > max;
+
+	template< class F >
+	void forEach( F f ) {
+		f( period );
+		f( offset );
+		f( exponent );
+		f( min );
+		f( max );
+	}
+};
+
+struct SinVelocityColumns : SinRangeColumns {
+	static constexpr size_t type = 2u;
+};
+struct SinSpinColumns : SinRangeColumns {
+	static constexpr size_t type = 5u;
+};
+
+struct SinAlphaColumns : SinColumns {
+	static constexpr size_t type = 3u;
+
+	vector< float > target;
+
+	template< class F >
+	void forEach( F f ) {
+		f( period );
+		f( offset );
+		f( exponent );
+		f( target );
+	}
+};
+
+struct SinColorColumns : SinColumns {
+	static constexpr size_t type = 4u;
+
+	vector< float > targetR;
+	vector< float > targetG;
+	vector< float > targetB;
+	vector< float > targetA;
+
+	template< class F >
+	void forEach( F f ) {
+		f( period );
+		f( offset );
+		f( exponent );
+		f( targetR );
+		f( targetG );
+		f( targetB );
+		f( targetA );
+	}
+};
+
+//--------------------------------------------------------------------------------
+
+struct FadeRangeColumns {
+	vector< float > start;
+	vector< float > end;
+	vector< float > exponent;
+
+	template< class F >
+	void forEach( F f ) {
+		f( start );
+		f( end );
+		f( exponent );
+	}
+};
+
+struct FadeVelocityColumns : FadeRangeColumns {
+	static constexpr size_t type = 6u;
+};
+struct FadeScaleColumns : FadeRangeColumns {
+	static constexpr size_t type = 7u;
+};
+
+struct FadeAlphaColumns {
+	static constexpr size_t type = 8u;
+
+	vector< float > target;
+	vector< float > exponent;
+
+	template< class F >
+	void forEach( F f ) {
+		f( target );
+		f( exponent );
+	}
+};
+
+struct FadeColorColumns {
+	static constexpr size_t type = 9u;
+
+	vector< float > targetR;
+	vector< float > targetG;
+	vector< float > targetB;
+	vector< float > targetA;
+	vector< float > exponent;
+
+	template< class F >
+	void forEach( F f ) {
+		f( targetR );
+		f( targetG );
+		f( targetB );
+		f( targetA );
+		f( exponent );
+	}
+};
+
+//================================================================================
+
+template< class Columns >
+struct Table {
+	static constexpr size_t type = Columns::type;
+
+	vector< ParticleHandle > particles;
+	Columns columns;
+
+	size_t size() const { return particles.size(); }
+
+	void clear() {
+		particles.clear();
+		columns.forEach( []( auto& column ) { column.clear(); } );
+	}
+
+	// Swap-removes rows whose particle is gone
+	void sweep( const Store& store ) {
+		size_t i = 0u;
+		while( i < particles.size() ) {
+			if( store.valid( particles[ i ] ) ) {
+				++i;
+				continue;
+			}
+
+			particles[ i ] = particles.back();
+			particles.pop_back();
+			columns.forEach( [i]( auto& column ) {
+				column[ i ] = column.back();
+				column.pop_back();
+			} );
+		}
+	}
+};
+
+//--------------------------------------------------------------------------------
+
+// Layer k holds the rows of the k-th batched affector of every pattern, so
+// layers run in the order patterns list their affectors. A particle gets at
+// most one row per layer, so a layer can be split across threads.
+struct Tables {
+	vector< Table< RotateToVelocityColumns > > rotateToVelocity;
+	vector< Table< SinPositionColumns > > sinPosition;
+	vector< Table< SinVelocityColumns > > sinVelocity;
+	vector< Table< SinAlphaColumns > > sinAlpha;
+	vector< Table< SinColorColumns > > sinColor;
+	vector< Table< SinSpinColumns > > sinSpin;
+	vector< Table< FadeVelocityColumns > > fadeVelocity;
+	vector< Table< FadeScaleColumns > > fadeScale;
+	vector< Table< FadeAlphaColumns > > fadeAlpha;
+	vector< Table< FadeColorColumns > > fadeColor;
+
+	static constexpr size_t typeCount = batchTypeCount;
+
+	// Visits every table in layer order as f( table, type, layer ). Within a
+	// layer no particle has rows in two tables, so the type order there is free.
+	template< class F >
+	void forEachLayer( F f ) {
+		size_t count = 0u;
+		forEachType( [&count]( auto& tables ) { count = std::max( count, tables.size() ); } );
+
+		for( size_t layer = 0u; layer < count; ++layer )
+			forEachType( [&f, layer]( auto& tables ) {
+				if( layer < tables.size() )
+					f( tables[ layer ], tables[ layer ].type, layer );
+			} );
+	}
+
+	template< class F >
+	void forEachType( F f ) {
+		f( rotateToVelocity );
+		f( sinPosition );
+		f( sinVelocity );
+		f( sinAlpha );
+		f( sinColor );
+		f( sinSpin );
+		f( fadeVelocity );
+		f( fadeScale );
+		f( fadeAlpha );
+		f( fadeColor );
+	}
+
+	template< class F >
+	void forEach( F f ) {
+		forEachLayer( [&f]( auto& table, size_t, size_t ) { f( table ); } );
+	}
+};
+
+// Row count of every layer, by type
+using TableMark = array< vector< size_t >, Tables::typeCount >;
+
+
+//--------------------------------------------------------------------------------
+
+// The table of the spawn's next layer, layers below it were taken by the
+// affectors listed before this one
+template< class Columns >
+Table< Columns >& nextLayer( vector< Table< Columns > >& tables, TableLayer& layer ) {
+	const size_t index = layer++;
+	if( tables.size() <= index )
+		tables.resize( index + 1u );
+	return tables[ index ];
+}
+
+//================================================================================
+
+Tables& getTables();
+// Rows of analytic particles, run on their own store when rendering
+Tables& getAnalyticTables();
+
+// Rows added after a mark can be run on their own, used at spawn
+TableMark markTables();
+
+void runTables( Store& store );
+void runTables( Store& store, const TableMark& from );
+void runTables( Tables& tables, Store& store );
+
+void sweepTables( const Store& store );
+void sweepTables( Tables& tables, const Store& store );
+void clearTables();
+void clearTables( Tables& tables );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Affector
+
+//================================================================================
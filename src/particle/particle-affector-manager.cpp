@@ -39,15 +39,19 @@ void init() {
 
 //--------------------------------------------------------------------------------
 
-void apply( Particle* target, sf::Time delta ) {
-	for( shared_ptr< Affector > affector : target->affectors )
-		affector->affect( target, delta );
+void apply( Store& store, size_t target, sf::Time delta ) {
+	for( const shared_ptr< Affector >& affector : store.affectors[ target ] )
+		affector->affect( store, target, delta );
+
+	if( store.sharedAffectors[ target ] )
+		for( const shared_ptr< Affector >& affector : *store.sharedAffectors[ target ] )
+			affector->affect( store, target, delta );
 }
 
 //--------------------------------------------------------------------------------
 
 void apply( Emitter* target, sf::Time delta ) {
-	for( shared_ptr< Affector > affector : target->affectors )
+	for( const shared_ptr< Affector >& affector : target->affectors )
 		affector->affect( target, delta );
 }
 
@@ -115,6 +119,63 @@ shared_ptr< AffectorCreator > setValue( const rapidjson::Value& value ) {
 
 //--------------------------------------------------------------------------------
 
+shared_ptr< AffectorCreator > setValue( json::Stream& in ) {
+	string name;
+	rapidjson::Value value;
+	const bool isObject = in.readObject( [&in, &name, &value]( std::string_view key ) {
+		if( key == "name" )
+			json::getValue( in, name );
+		else if( key == "value" )
+			in.readValue( value );
+	} );
+
+	if( !isObject || name.empty() || value.IsNull() )
+		return nullptr;
+
+	const auto it = std::find_if( factories.begin(), factories.end(),
+								  [&name]( const unique_ptr< AffectorFactory >& factory ) {
+									  return factory->getName() == name;
+								  } );
+
+	if( it == factories.end() )
+		return nullptr;
+
+	shared_ptr< AffectorCreator > out = ( *it )->createCreator();
+	out->setValue( value );
+
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+void write( Binary::Writer& out, const shared_ptr< AffectorCreator >& affector ) {
+	out.write( affector->getName() );
+	affector->write( out );
+}
+
+//--------------------------------------------------------------------------------
+
+shared_ptr< AffectorCreator > read( Binary::Reader& in ) {
+	string name;
+	if( !in.read( name ) )
+		return nullptr;
+
+	const auto it = std::find_if( factories.begin(), factories.end(),
+								  [&name]( const unique_ptr< AffectorFactory >& factory ) {
+									  return factory->getName() == name;
+								  } );
+
+	if( it == factories.end() )
+		return nullptr;
+
+	shared_ptr< AffectorCreator > out = ( *it )->createCreator();
+	out->read( in );
+
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
 }
 
 //================================================================================
\ No newline at end of file
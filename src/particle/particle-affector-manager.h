@@ -6,6 +6,7 @@
 
 #include "global.h"
 
+#include "binary.h"
 #include "mathtypes.h"
 #include "random.h"
 #include "debug.h"
@@ -17,7 +18,7 @@ namespace Gfx::Particle {
 
 //--------------------------------------------------------------------------------
 
-struct Particle;
+struct Store;
 struct Emitter;
 class System;
 
@@ -31,7 +32,7 @@ class AffectorCreator;
 
 void init();
 
-void apply( Particle* target, sf::Time delta );
+void apply( Store& store, size_t target, sf::Time delta );
 void apply( Emitter* target, sf::Time delta );
 void apply( System* target, sf::Time delta );
 
@@ -39,6 +40,12 @@ bool render( list< shared_ptr< AffectorCreator > >& out );
 
 rapidjson::Value getValue( shared_ptr< AffectorCreator > affector );
 shared_ptr< AffectorCreator > setValue( const rapidjson::Value& value );
+// The creator's value is small, so it still goes through the stream's arena DOM
+shared_ptr< AffectorCreator > setValue( json::Stream& in );
+
+void write( Binary::Writer& out, const shared_ptr< AffectorCreator >& affector );
+// nullptr for unknown affectors, the rest of the data can't be read then
+shared_ptr< AffectorCreator > read( Binary::Reader& in );
 
 //--------------------------------------------------------------------------------
 
@@ -10,6 +10,7 @@
 #include "json.h"
 #include "mathtypes.h"
 #include "particle-affector.h"
+#include "particle-affector-batch.h"
 #include "particle-emitter.h"
 #include "particle-loader.h"
 #include "particle-system.h"
@@ -23,9 +24,18 @@ namespace Gfx::Particle::Affector {
 
 //--------------------------------------------------------------------------------
 
+// Spawn ages of one EmitterAffector::affect, particles are affected from jobs
+thread_local vector< microseconds > emitAges;
+
+//================================================================================
+
 void Affector::affect( Emitter* target, sf::Time delta ) {
-	for( Particle* particle : target->particles )
-		affect( particle, delta );
+	Store& store = Manager::getStore();
+	for( ParticleHandle handle : target->particles ) {
+		const size_t particle = store.resolve( handle );
+		if( particle != Store::none )
+			affect( store, particle, delta );
+	}
 }
 
 //--------------------------------------------------------------------------------
@@ -42,9 +52,8 @@ void Affector::affect( System* target, sf::Time delta ) {
 //================================================================================
 
 
-void RotateToVelocityAffector::affect( Particle* target, sf::Time delta ) {
-	const float angle = target->frame.velocity.angle() + m_offset;
-	target->frame.transform.setRotation( angle );
+void RotateToVelocityAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::rotateToVelocity( store, target, m_offset );
 }
 
 //--------------------------------------------------------------------------------
@@ -71,6 +80,18 @@ shared_ptr< Affector > RotateToVelocityAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void RotateToVelocityAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< RotateToVelocityColumns >& table = nextLayer( tables.rotateToVelocity, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_offset );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.offset.push_back( m_offset.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value RotateToVelocityAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -90,20 +111,26 @@ void RotateToVelocityAffectorCreator::setValue( const rapidjson::Value& value )
 		json::getValue( value["offset"], m_offset );
 }
 
+//--------------------------------------------------------------------------------
+
+void RotateToVelocityAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_offset );
+}
+
+//--------------------------------------------------------------------------------
+
+void RotateToVelocityAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_offset );
+}
+
 //================================================================================
 
 // SIN
 
 //================================================================================
 
-void SinPositionAffector::affect( Particle* target, sf::Time delta ) {
-	const float alpha
-		= ( float ) target->frame.duration.count() / ( float ) m_period.count() + m_offset;
-	const float sin		   = ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
-	const float amp		   = powf( sin, m_exponent );
-	const sf::Vector2f pos = Math::mix( sf::Vector2f(), m_target.sf(), amp );
-
-	target->frame.transform.move( pos );
+void SinPositionAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::sinPosition( store, target, ( float )m_period.count(), m_target, m_offset, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -139,6 +166,25 @@ shared_ptr< Affector > SinPositionAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void SinPositionAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< SinPositionColumns >& table = nextLayer( tables.sinPosition, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_period );
+		Math::processSet( m_offset );
+		Math::processSet( m_exponent );
+		const Math::Vec2 target = m_target.process( 1, 1 );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.period.push_back( ( float )microseconds( milliseconds( m_period.value ) ).count() );
+		table.columns.offset.push_back( m_offset.value );
+		table.columns.exponent.push_back( m_exponent.value );
+		table.columns.targetX.push_back( target.x );
+		table.columns.targetY.push_back( target.y );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value SinPositionAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -167,16 +213,22 @@ void SinPositionAffectorCreator::setValue( const rapidjson::Value& value ) {
 		m_target.setValue( value["target"] );
 }
 
-//================================================================================
+//--------------------------------------------------------------------------------
+
+void SinPositionAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_period, m_target, m_offset, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void SinPositionAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_period, m_target, m_offset, m_exponent );
+}
 
-void SinVelocityAffector::affect( Particle* target, sf::Time delta ) {
-	const float alpha
-		= ( float ) target->frame.duration.count() / ( float ) m_period.count() + m_offset;
-	const float sin = ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
-	const float amp = Math::mix( m_min, m_max, powf( sin, m_exponent ) );
+//================================================================================
 
-	Math::Vec2 vel		   = target->frame.velocity * amp;
-	target->frame.velocity = vel;
+void SinVelocityAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::sinVelocity( store, target, ( float )m_period.count(), m_min, m_max, m_offset, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -216,6 +268,26 @@ shared_ptr< Affector > SinVelocityAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void SinVelocityAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< SinVelocityColumns >& table = nextLayer( tables.sinVelocity, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_period );
+		Math::processSet( m_min );
+		Math::processSet( m_max );
+		Math::processSet( m_offset );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.period.push_back( ( float )microseconds( milliseconds( m_period.value ) ).count() );
+		table.columns.offset.push_back( m_offset.value );
+		table.columns.exponent.push_back( m_exponent.value );
+		table.columns.min.push_back( m_min.value );
+		table.columns.max.push_back( m_max.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value SinVelocityAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -247,18 +319,22 @@ void SinVelocityAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["max"], m_max );
 }
 
-//================================================================================
+//--------------------------------------------------------------------------------
 
-void SinAlphaAffector::affect( Particle* target, sf::Time delta ) {
-	if( m_period == 0ms )
-		return;
+void SinVelocityAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_period, m_min, m_max, m_offset, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
 
-	const float alpha
-		= ( float ) target->frame.duration.count() / ( float ) m_period.count() + m_offset;
-	const float sin = ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
-	const float a = Math::mix( target->frame.color.a, m_target, powf( sin, m_exponent ) );
+void SinVelocityAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_period, m_min, m_max, m_offset, m_exponent );
+}
+
+//================================================================================
 
-	target->frame.color.a = a;
+void SinAlphaAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::sinAlpha( store, target, ( float )m_period.count(), m_target, m_offset, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -295,6 +371,24 @@ shared_ptr< Affector > SinAlphaAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void SinAlphaAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< SinAlphaColumns >& table = nextLayer( tables.sinAlpha, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_period );
+		Math::processSet( m_target );
+		Math::processSet( m_offset );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.period.push_back( ( float )microseconds( milliseconds( m_period.value ) ).count() );
+		table.columns.offset.push_back( m_offset.value );
+		table.columns.exponent.push_back( m_exponent.value );
+		table.columns.target.push_back( m_target.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value SinAlphaAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -323,16 +417,22 @@ void SinAlphaAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["target"], m_target );
 }
 
-//================================================================================
+//--------------------------------------------------------------------------------
+
+void SinAlphaAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_period, m_target, m_offset, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
 
-void SinColorAffector::affect( Particle* target, sf::Time delta ) {
-	const float alpha
-		= ( float ) target->frame.duration.count() / ( float ) m_period.count() + m_offset;
-	const float sin = ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
-	const Math::Color color
-		= Math::mix( target->frame.color, m_target, powf( sin, m_exponent ) );
+void SinAlphaAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_period, m_target, m_offset, m_exponent );
+}
 
-	target->frame.color = color;
+//================================================================================
+
+void SinColorAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::sinColor( store, target, ( float )m_period.count(), m_target, m_offset, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -369,6 +469,27 @@ shared_ptr< Affector > SinColorAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void SinColorAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< SinColorColumns >& table = nextLayer( tables.sinColor, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_period );
+		Math::processSet( m_target );
+		Math::processSet( m_offset );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.period.push_back( ( float )microseconds( milliseconds( m_period.value ) ).count() );
+		table.columns.offset.push_back( m_offset.value );
+		table.columns.exponent.push_back( m_exponent.value );
+		table.columns.targetR.push_back( m_target.value.r );
+		table.columns.targetG.push_back( m_target.value.g );
+		table.columns.targetB.push_back( m_target.value.b );
+		table.columns.targetA.push_back( m_target.value.a );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value SinColorAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -397,15 +518,22 @@ void SinColorAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["target"], m_target );
 }
 
-//================================================================================
+//--------------------------------------------------------------------------------
+
+void SinColorAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_period, m_target, m_offset, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
 
-void SinSpinAffector::affect( Particle* target, sf::Time delta ) {
-	const float alpha
-		= ( float ) target->frame.duration.count() / ( float ) m_period.count() + m_offset;
-	const float sin = ( cosf( ( alpha + 1.f ) * PI ) + 1.f ) / 2.f;
-	const float mul = Math::mix( m_min, m_max, powf( sin, m_exponent ) );
+void SinColorAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_period, m_target, m_offset, m_exponent );
+}
+
+//================================================================================
 
-	target->frame.spin = target->frame.spin * mul;
+void SinSpinAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::sinSpin( store, target, ( float )m_period.count(), m_min, m_max, m_offset, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -445,6 +573,26 @@ shared_ptr< Affector > SinSpinAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void SinSpinAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< SinSpinColumns >& table = nextLayer( tables.sinSpin, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_period );
+		Math::processSet( m_min );
+		Math::processSet( m_max );
+		Math::processSet( m_offset );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.period.push_back( ( float )microseconds( milliseconds( m_period.value ) ).count() );
+		table.columns.offset.push_back( m_offset.value );
+		table.columns.exponent.push_back( m_exponent.value );
+		table.columns.min.push_back( m_min.value );
+		table.columns.max.push_back( m_max.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value SinSpinAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -476,18 +624,26 @@ void SinSpinAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["max"], m_max );
 }
 
+//--------------------------------------------------------------------------------
+
+void SinSpinAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_period, m_min, m_max, m_offset, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void SinSpinAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_period, m_min, m_max, m_offset, m_exponent );
+}
+
 //================================================================================
 
 // FADES
 
 //================================================================================
 
-void FadeVelocityAffector::affect( Particle* target, sf::Time delta ) {
-	float alpha = 1.0f
-				  - ( ( float ) target->current.remaining.count()
-					  / ( float ) target->initial.remaining.count() );
-	alpha = powf( alpha, m_exponent );
-	target->frame.velocity = target->frame.velocity * Math::mix( m_start, m_end, alpha );
+void FadeVelocityAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::fadeVelocity( store, target, m_start, m_end, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -520,6 +676,22 @@ shared_ptr< Affector > FadeVelocityAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void FadeVelocityAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< FadeVelocityColumns >& table = nextLayer( tables.fadeVelocity, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_start );
+		Math::processSet( m_end );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.start.push_back( m_start.value );
+		table.columns.end.push_back( m_end.value );
+		table.columns.exponent.push_back( m_exponent.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value FadeVelocityAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -545,15 +717,22 @@ void FadeVelocityAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["exponent"], m_exponent );
 }
 
+//--------------------------------------------------------------------------------
+
+void FadeVelocityAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_start, m_end, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void FadeVelocityAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_start, m_end, m_exponent );
+}
+
 //================================================================================
 
-void FadeScaleAffector::affect( Particle* target, sf::Time delta ) {
-	float alpha = 1.0f
-				  - ( ( float ) target->current.remaining.count()
-					  / ( float ) target->initial.remaining.count() );
-	alpha = powf( alpha, m_exponent );
-	target->frame.transform.setScale( target->frame.transform.getScale()
-									  * Math::mix( m_start, m_end, alpha ) );
+void FadeScaleAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::fadeScale( store, target, m_start, m_end, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -586,6 +765,22 @@ shared_ptr< Affector > FadeScaleAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void FadeScaleAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< FadeScaleColumns >& table = nextLayer( tables.fadeScale, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_start );
+		Math::processSet( m_end );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.start.push_back( m_start.value );
+		table.columns.end.push_back( m_end.value );
+		table.columns.exponent.push_back( m_exponent.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value FadeScaleAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -611,14 +806,22 @@ void FadeScaleAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["exponent"], m_exponent );
 }
 
+//--------------------------------------------------------------------------------
+
+void FadeScaleAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_start, m_end, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void FadeScaleAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_start, m_end, m_exponent );
+}
+
 //================================================================================
 
-void FadeAlphaAffector::affect( Particle* target, sf::Time delta ) {
-	float alpha = 1.0f
-				  - ( ( float ) target->current.remaining.count()
-					  / ( float ) target->initial.remaining.count() );
-	alpha				  = powf( alpha, m_exponent );
-	target->frame.color.a = Math::mix( target->frame.color.a, m_target, alpha );
+void FadeAlphaAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::fadeAlpha( store, target, m_target, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -648,6 +851,20 @@ shared_ptr< Affector > FadeAlphaAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void FadeAlphaAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< FadeAlphaColumns >& table = nextLayer( tables.fadeAlpha, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_target );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.target.push_back( m_target.value );
+		table.columns.exponent.push_back( m_exponent.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value FadeAlphaAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -670,15 +887,22 @@ void FadeAlphaAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["exponent"], m_exponent );
 }
 
+//--------------------------------------------------------------------------------
+
+void FadeAlphaAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_target, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void FadeAlphaAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_target, m_exponent );
+}
+
 //================================================================================
 
-void FadeColorAffector::affect( Particle* target, sf::Time delta ) {
-	float alpha = 1.0f
-				  - ( ( float ) target->current.remaining.count()
-					  / ( float ) target->initial.remaining.count() );
-	alpha				= powf( alpha, m_exponent );
-	target->frame.color = Math::mix( target->frame.color, m_target, alpha );
-	target->frame.color.a = Math::mix( target->frame.color.a, m_target.a, alpha );
+void FadeColorAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	Kernel::fadeColor( store, target, m_target, m_exponent );
 }
 
 //--------------------------------------------------------------------------------
@@ -708,6 +932,23 @@ shared_ptr< Affector > FadeColorAffectorCreator::get() {
 
 //--------------------------------------------------------------------------------
 
+void FadeColorAffectorCreator::add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {
+	Table< FadeColorColumns >& table = nextLayer( tables.fadeColor, layer );
+	for( size_t i = range.first; i < range.last; ++i ) {
+		Math::processSet( m_target );
+		Math::processSet( m_exponent );
+
+		table.particles.push_back( store.handle( i ) );
+		table.columns.targetR.push_back( m_target.value.r );
+		table.columns.targetG.push_back( m_target.value.g );
+		table.columns.targetB.push_back( m_target.value.b );
+		table.columns.targetA.push_back( m_target.value.a );
+		table.columns.exponent.push_back( m_exponent.value );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 rapidjson::Value FadeColorAffectorCreator::getValue() {
 	rapidjson::Value out;
 	out.SetObject();
@@ -730,53 +971,77 @@ void FadeColorAffectorCreator::setValue( const rapidjson::Value& value ) {
 		json::getValue( value["exponent"], m_exponent );
 }
 
+//--------------------------------------------------------------------------------
+
+void FadeColorAffectorCreator::write( Binary::Writer& out ) const {
+	out.write( m_target, m_exponent );
+}
+
+//--------------------------------------------------------------------------------
+
+void FadeColorAffectorCreator::read( Binary::Reader& in ) {
+	in.read( m_target, m_exponent );
+}
+
 //================================================================================
 
 // Emission
 
 //================================================================================
 
-void OnDeathEmitterAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->alive || m_patterns.empty() )
+void OnDeathEmitterAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	if( store.alive[ target ] || m_patterns.empty() )
 		return;
 
 	if( m_type == EmitterType::Set ) {
-		for( ParticlePattern* pattern : m_patterns )
-			Manager::spawnParticle( *pattern, target );
+		for( const CompiledPattern* pattern : m_patterns )
+			Manager::queueSpawn( *pattern, store.handle( target ) );
 	}
 	else if( m_type == EmitterType::Random ) {
-		Manager::spawnParticle( *Random::getElement( m_patterns ), target );
+		Manager::queueSpawn( *Random::getElement( m_patterns ), store.handle( target ) );
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void EmitterAffector::affect( Particle* target, sf::Time delta ) {
+void EmitterAffector::affect( Store& store, size_t target, sf::Time delta ) {
 	if( m_finished || m_patterns.empty() )
 		return;
 
 	m_elapsed += microseconds( delta.asMicroseconds() );
 
-	if( m_elapsed > m_next ) {
+	// Every spawn that came due during the frame, aged by how long ago
+	emitAges.clear();
+	while( m_elapsed > m_next ) {
+		emitAges.push_back( m_elapsed - m_next );
+
 		Math::processSet( m_spawnRate );
-		if( m_spawnRate.value != 0.f )
-			m_next = m_elapsed + milliseconds( ( int ) ( 1000.f / m_spawnRate.value ) );
-		else
+		if( m_spawnRate.value <= 0.f ) {
 			m_duration = -1ms;
+			break;
+		}
 
-		switch( m_type ) {
-			case EmitterType::Set:
-				for( ParticlePattern* pattern : m_patterns )
-					Manager::spawnParticle( *pattern, target );
-				break;
-			case EmitterType::Random:
-				Manager::spawnParticle( *Random::getElement( m_patterns ), target );
-				break;
-			case EmitterType::Sequence:
-				Manager::spawnParticle( *m_patterns.at( m_index++ ) );
+		m_next += std::max( microseconds( int64_t( 1000000.f / m_spawnRate.value ) ), 1us );
+	}
+
+	// Per pattern, so the queued requests of one pattern batch together
+	const ParticleHandle handle = store.handle( target );
+	switch( m_type ) {
+		case EmitterType::Set:
+			for( const CompiledPattern* pattern : m_patterns )
+				for( microseconds age : emitAges )
+					Manager::queueSpawn( *pattern, handle, age );
+			break;
+		case EmitterType::Random:
+			for( microseconds age : emitAges )
+				Manager::queueSpawn( *Random::getElement( m_patterns ), handle, age );
+			break;
+		case EmitterType::Sequence:
+			for( microseconds age : emitAges ) {
+				Manager::queueSpawn( *m_patterns.at( m_index++ ), ParticleHandle(), age );
 				if( m_index == m_patterns.size() )
 					m_index = 0u;
-		}
+			}
 	}
 
 	if( m_duration != 0ms && m_elapsed > m_duration )
@@ -789,197 +1054,195 @@ void EmitterAffector::affect( Particle* target, sf::Time delta ) {
 
 //================================================================================
 
-void InheritLifetimeAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
-		return;
-
-	switch( m_type ) {
-		case InheritanceType::None: break;
-		case InheritanceType::Copy:
-		case InheritanceType::Offset:
-		case InheritanceType::Multiply: target->alive = target->parent->alive;
-	}
-}
-
-//--------------------------------------------------------------------------------
-
-void InheritPositionAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritPositionAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.transform.setPosition( target->parent->frame.transform.getPosition() );
+			store.frame.setPosition( target, store.frame.getPosition( parent ) );
 			break;
 		case InheritanceType::Offset:
-			target->frame.transform.move( target->parent->frame.transform.getPosition() );
+			store.frame.setPosition(
+				target, store.frame.getPosition( target ) + store.frame.getPosition( parent ) );
 			break;
 		case InheritanceType::Multiply:
-			Math::Vec2 pos = target->frame.transform.getPosition();
-			pos *= target->parent->frame.transform.getPosition();
-			target->frame.transform.move( pos.sf() );
+			Math::Vec2 pos = store.frame.getPosition( target );
+			pos *= store.frame.getPosition( parent );
+			store.frame.setPosition( target, store.frame.getPosition( target ) + pos );
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritRotationAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritRotationAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.transform.setRotation( target->parent->frame.transform.getRotation() );
+			store.frame.rotation[ target ] = store.frame.getRotation( parent );
 			break;
 		case InheritanceType::Offset:
-			target->frame.transform.rotate( target->parent->frame.transform.getRotation() );
+			store.frame.rotation[ target ] += store.frame.getRotation( parent );
 			break;
 		case InheritanceType::Multiply:
-			float rot = target->frame.transform.getRotation();
-			rot *= target->parent->frame.transform.getRotation();
-			target->frame.transform.rotate( rot );
+			float rot = store.frame.getRotation( target );
+			rot *= store.frame.getRotation( parent );
+			store.frame.rotation[ target ] += rot;
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritSpinAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritSpinAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.spin = target->parent->frame.spin;
+			store.frame.spin[ target ] = store.frame.spin[ parent ];
 			break;
 		case InheritanceType::Offset:
-			target->frame.spin += target->parent->frame.spin;
+			store.frame.spin[ target ] += store.frame.spin[ parent ];
 			break;
 		case InheritanceType::Multiply:
-			target->frame.spin *= target->parent->frame.spin;
+			store.frame.spin[ target ] *= store.frame.spin[ parent ];
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritScaleAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritScaleAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.transform.setScale( target->parent->frame.transform.getScale() );
+			store.frame.setScale( target, store.frame.getScale( parent ) );
 			break;
 		case InheritanceType::Offset:
-			target->frame.transform.scale( target->parent->frame.transform.getScale() );
+			store.frame.setScale( target, store.frame.getScale( target ) * store.frame.getScale( parent ) );
 			break;
 		case InheritanceType::Multiply:
-			Math::Vec2 s = target->frame.transform.getScale();
-			s *= target->parent->frame.transform.getScale();
-			target->frame.transform.scale( s.sf() );
+			Math::Vec2 s = store.frame.getScale( target );
+			s *= store.frame.getScale( parent );
+			store.frame.setScale( target, store.frame.getScale( target ) * s );
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritColorAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritColorAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
+	PropertyColumns& frame = store.frame;
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.color.r = target->parent->frame.color.r;
-			target->frame.color.g = target->parent->frame.color.g;
-			target->frame.color.b = target->parent->frame.color.b;
+			frame.colorR[ target ] = frame.colorR[ parent ];
+			frame.colorG[ target ] = frame.colorG[ parent ];
+			frame.colorB[ target ] = frame.colorB[ parent ];
 			break;
 		case InheritanceType::Offset:
-			target->frame.color.r += target->parent->frame.color.r;
-			target->frame.color.g += target->parent->frame.color.g;
-			target->frame.color.b += target->parent->frame.color.b;
+			frame.colorR[ target ] += frame.colorR[ parent ];
+			frame.colorG[ target ] += frame.colorG[ parent ];
+			frame.colorB[ target ] += frame.colorB[ parent ];
 			break;
 		case InheritanceType::Multiply:
-			target->frame.color.r *= target->parent->frame.color.r;
-			target->frame.color.g *= target->parent->frame.color.g;
-			target->frame.color.b *= target->parent->frame.color.b;
+			frame.colorR[ target ] *= frame.colorR[ parent ];
+			frame.colorG[ target ] *= frame.colorG[ parent ];
+			frame.colorB[ target ] *= frame.colorB[ parent ];
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritAlphaAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritAlphaAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.color.a = target->parent->frame.color.a;
+			store.frame.colorA[ target ] = store.frame.colorA[ parent ];
 			break;
 		case InheritanceType::Offset:
-			target->frame.color.a += target->parent->frame.color.a;
+			store.frame.colorA[ target ] += store.frame.colorA[ parent ];
 			break;
 		case InheritanceType::Multiply:
-			target->frame.color.a *= target->parent->frame.color.a;
+			store.frame.colorA[ target ] *= store.frame.colorA[ parent ];
 			break;
 	}
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritVelocityAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritVelocityAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
+	Math::Vec2 velocity = store.frame.getVelocity( target );
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.velocity = target->parent->frame.velocity;
+			velocity = store.frame.getVelocity( parent );
 			break;
 		case InheritanceType::Offset:
-			target->frame.velocity += target->parent->frame.velocity;
+			velocity += store.frame.getVelocity( parent );
 			break;
 		case InheritanceType::Multiply:
-			target->frame.velocity *= target->parent->frame.velocity;
+			velocity *= store.frame.getVelocity( parent );
 			break;
 	}
 
-	if( m_scale ) {
-		sf::Transform t;
-		t.scale( target->parent->frame.transform.getScale() );
-		target->frame.velocity = t.transformPoint( target->frame.velocity.sf() );
-	}
+	if( m_scale )
+		velocity *= store.frame.getScale( parent );
 	if( m_rotate ) {
 		sf::Transform t;
-		t.rotate( target->parent->frame.transform.getRotation() );
-		target->frame.velocity = t.transformPoint( target->frame.velocity.sf() );
+		t.rotate( store.frame.getRotation( parent ) );
+		velocity = t.transformPoint( velocity.sf() );
 	}
+
+	store.frame.setVelocity( target, velocity );
 }
 
 //--------------------------------------------------------------------------------
 
-void InheritAccelerationAffector::affect( Particle* target, sf::Time delta ) {
-	if( target->parent == nullptr )
+void InheritAccelerationAffector::affect( Store& store, size_t target, sf::Time delta ) {
+	const size_t parent = store.resolve( store.parent[ target ] );
+	if( parent == Store::none )
 		return;
 
 	switch( m_type ) {
 		case InheritanceType::None: break;
 		case InheritanceType::Copy:
-			target->frame.acceleration = target->parent->frame.acceleration;
+			store.frame.setAcceleration( target, store.frame.getAcceleration( parent ) );
 			break;
 		case InheritanceType::Offset:
-			target->frame.acceleration += target->parent->frame.acceleration;
+			store.frame.setAcceleration(
+				target, store.frame.getAcceleration( target ) + store.frame.getAcceleration( parent ) );
 			break;
 		case InheritanceType::Multiply:
-			target->frame.acceleration *= target->parent->frame.acceleration;
+			store.frame.setAcceleration(
+				target, store.frame.getAcceleration( target ) * store.frame.getAcceleration( parent ) );
 			break;
 	}
 }
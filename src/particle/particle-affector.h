@@ -4,25 +4,38 @@
 
 //================================================================================
 
+#include "binary.h"
 #include "debug.h"
 #include "global.h"
 #include "mathtypes.h"
+#include "particle-store.h"
 
 #include <rapidjson/document.h>
+#include <tuple>
 
 //================================================================================
 
 namespace Gfx::Particle {
 
 struct Particle;
+struct Store;
 struct Emitter;
 class System;
-struct ParticlePattern;
+struct CompiledPattern;
 
 //--------------------------------------------------------------------------------
 
 namespace Affector {
 
+struct Tables;
+
+// Batched affector types, see particle-affector-batch.h
+constexpr size_t batchTypeCount = 10u;
+
+// Next layer of a spawn's rows, the position of the affector among its
+// pattern's batched ones
+using TableLayer = size_t;
+
 //--------------------------------------------------------------------------------
 
 class Affector {
@@ -30,7 +43,7 @@ public:
 	Affector()			= default;
 	virtual ~Affector() = default;
 
-	virtual void affect( Particle* target, sf::Time delta ) {}
+	virtual void affect( Store& store, size_t target, sf::Time delta ) {}
 	virtual void affect( Emitter* target, sf::Time delta );
 	virtual void affect( System* target, sf::Time delta );
 };
@@ -45,9 +58,23 @@ public:
 	virtual bool render()				 = 0;
 	virtual shared_ptr< Affector > get() = 0;
 
+	// Stateless affectors add a row per particle in range to their type's
+	// table instead of spawning with an instance each. get() is still used
+	// where an instance is needed, like emitter affectors.
+	virtual bool isBatched() const { return false; }
+	virtual void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) {}
+
+	// Only reads spawn state and age, so analytic patterns can use it.
+	// See ParticlePattern::analytic.
+	virtual bool isAnalytic() const { return false; }
+
 	virtual rapidjson::Value getValue()					   = 0;
 	virtual void setValue( const rapidjson::Value& value ) = 0;
 
+	// Binary counterparts of getValue/setValue, see Loader
+	virtual void write( Binary::Writer& out ) const = 0;
+	virtual void read( Binary::Reader& in )		  = 0;
+
 	virtual string getName() const = 0;
 };
 
@@ -72,7 +99,7 @@ class RotateToVelocityAffector : public Affector {
 public:
 	RotateToVelocityAffector( float offset ) : m_offset( offset ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	float m_offset{ 0.f };
@@ -86,8 +113,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Rotate To Velocity"; }
 
@@ -120,7 +152,7 @@ public:
 		m_period( period ), m_target( target ), m_offset( offset ),
 		m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	microseconds m_period;
@@ -137,8 +169,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Sine Position"; }
 
@@ -170,7 +207,7 @@ public:
 		m_period( period ), m_min( min ), m_max( max ), m_offset( offset ),
 		m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	microseconds m_period;
@@ -188,8 +225,12 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Sine Velocity"; }
 
@@ -222,7 +263,7 @@ public:
 		m_period( period ), m_target( target ), m_offset( offset ),
 		m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	microseconds m_period;
@@ -239,8 +280,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Sine Alpha"; }
 
@@ -272,7 +318,7 @@ public:
 		m_period( period ), m_target( target ), m_offset( offset ),
 		m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	microseconds m_period;
@@ -289,8 +335,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Sine Color"; }
 
@@ -322,7 +373,7 @@ public:
 		m_period( period ), m_min( min ), m_max( max ), m_offset( offset ),
 		m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	microseconds m_period;
@@ -340,8 +391,12 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Sine Spin"; }
 
@@ -377,7 +432,7 @@ public:
 	FadeVelocityAffector( float start, float end, float exponent ) :
 		m_start( start ), m_end( end ), m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	float m_start;
@@ -393,8 +448,12 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Fade Velocity"; }
 
@@ -424,7 +483,7 @@ public:
 	FadeScaleAffector( float start, float end, float exponent ) :
 		m_start( start ), m_end( end ), m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	float m_start;
@@ -440,8 +499,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Fade Scale"; }
 
@@ -470,7 +534,7 @@ class FadeAlphaAffector : public Affector {
 public:
 	FadeAlphaAffector( float target, float exponent ) :
 		m_target( target ), m_exponent( exponent ) {}
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	float m_target;
@@ -485,8 +549,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Fade Alpha"; }
 
@@ -515,7 +584,7 @@ public:
 	FadeColorAffector( Math::Color target, float exponent ) :
 		m_target( target ), m_exponent( exponent ) {}
 
-	void affect( Particle* target, sf::Time delta ) override;
+	void affect( Store& store, size_t target, sf::Time delta ) override;
 
 private:
 	Math::Color m_target;
@@ -530,8 +599,13 @@ public:
 
 	bool render() override;
 	shared_ptr< Affector > get() override;
+	bool isBatched() const override { return true; }
+	bool isAnalytic() const override { return true; }
+	void add( Tables& tables, TableLayer& layer, const Store& store, ParticleRange range ) override;
 	rapidjson::Value getValue() override;
 	void setValue( const rapidjson::Value& value ) override;
+	void write( Binary::Writer& out ) const override;
+	void read( Binary::Reader& in ) override;
 
 	string getName() const override { return "Fade Color"; }
 
@@ -561,13 +635,13 @@ public:
 
 class OnDeathEmitterAffector : public Affector {
 public:
-	OnDeathEmitterAffector( EmitterType type, vector< ParticlePattern* > patterns ) :
+	OnDeathEmitterAffector( EmitterType type, vector< const CompiledPattern* > patterns ) :
 		Affector(), m_patterns( patterns ), m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
-	vector< ParticlePattern* > m_patterns;
+	vector< const CompiledPattern* > m_patterns;
 	EmitterType m_type;
 };
 
@@ -579,12 +653,12 @@ public:
 					 milliseconds delay,
 					 milliseconds duration,
 					 Math::ValueSet< float > spawnRate,
-					 vector< ParticlePattern* > patterns ) :
+					 vector< const CompiledPattern* > patterns ) :
 		Affector(),
 		m_type( type ), m_duration( duration ), m_elapsed( 0ms ),
 		m_next( delay ), m_spawnRate( spawnRate ), m_patterns( patterns ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	EmitterType m_type;
@@ -592,7 +666,7 @@ private:
 	microseconds m_elapsed;
 	microseconds m_next;
 	Math::ValueSet< float > m_spawnRate;
-	vector< ParticlePattern* > m_patterns;
+	vector< const CompiledPattern* > m_patterns;
 
 	bool m_finished{ false };
 	size_t m_index{ 0 };
@@ -604,23 +678,11 @@ private:
 
 //================================================================================
 
-class InheritLifetimeAffector : public Affector {
-public:
-	InheritLifetimeAffector( InheritanceType type ) : m_type( type ) {}
-
-	void affect( Particle* target, sf::Time delta );
-
-private:
-	InheritanceType m_type;
-};
-
-//--------------------------------------------------------------------------------
-
 class InheritPositionAffector : public Affector {
 public:
 	InheritPositionAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -632,7 +694,7 @@ class InheritRotationAffector : public Affector {
 public:
 	InheritRotationAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -644,7 +706,7 @@ class InheritSpinAffector : public Affector {
 public:
 	InheritSpinAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -656,7 +718,7 @@ class InheritScaleAffector : public Affector {
 public:
 	InheritScaleAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -668,7 +730,7 @@ class InheritColorAffector : public Affector {
 public:
 	InheritColorAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -680,7 +742,7 @@ class InheritAlphaAffector : public Affector {
 public:
 	InheritAlphaAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -693,7 +755,7 @@ public:
 	InheritVelocityAffector( InheritanceType type, bool scale, bool rotate ) :
 		m_type( type ), m_scale( scale ), m_rotate( rotate ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -707,7 +769,7 @@ class InheritAccelerationAffector : public Affector {
 public:
 	InheritAccelerationAffector( InheritanceType type ) : m_type( type ) {}
 
-	void affect( Particle* target, sf::Time delta );
+	void affect( Store& store, size_t target, sf::Time delta );
 
 private:
 	InheritanceType m_type;
@@ -715,6 +777,20 @@ private:
 
 //--------------------------------------------------------------------------------
 
+// One immutable instance per distinct set of constructor arguments, shared by
+// every particle that uses it. Spawning runs on the main thread only.
+template< class T, class... Args >
+shared_ptr< Affector > getShared( Args... args ) {
+	static map< std::tuple< Args... >, shared_ptr< Affector > > instances;
+
+	shared_ptr< Affector >& out = instances[ std::make_tuple( args... ) ];
+	if( !out )
+		out = make_shared< T >( args... );
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
 }	 // namespace Affector
 }	 // namespace Gfx::Particle
 
@@ -0,0 +1,58 @@
+//================================================================================
+
+#include "particle-analytic.h"
+
+//================================================================================
+
+namespace Gfx::Particle::Analytic {
+
+//--------------------------------------------------------------------------------
+
+void expire( Store& store, microseconds now, size_t begin, size_t end ) {
+	for( size_t i = begin; i < end; ++i ) {
+		if( store.lifetime[ i ] > 0ms && now - store.spawned[ i ] >= store.lifetime[ i ] )
+			store.alive[ i ] = false;
+		if( store.dead[ i ] )
+			store.alive[ i ] = false;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void evaluate( Store& store, microseconds now, size_t begin, size_t end ) {
+	const PropertyColumns& initial = store.current;
+	PropertyColumns& frame		   = store.frame;
+
+	for( size_t id = begin; id < end; ++id ) {
+		const microseconds age = now - store.spawned[ id ];
+		const float t		   = float( age.count() ) / 1000000.f;
+		const float halfT2	   = t * t * .5f;
+
+		frame.positionX[ id ] = initial.positionX[ id ] + initial.velocityX[ id ] * t + initial.accelerationX[ id ] * halfT2;
+		frame.positionY[ id ] = initial.positionY[ id ] + initial.velocityY[ id ] * t + initial.accelerationY[ id ] * halfT2;
+		frame.velocityX[ id ] = initial.velocityX[ id ] + initial.accelerationX[ id ] * t;
+		frame.velocityY[ id ] = initial.velocityY[ id ] + initial.accelerationY[ id ] * t;
+		frame.rotation[ id ]  = initial.rotation[ id ] + initial.spin[ id ] * t;
+
+		frame.accelerationX[ id ] = initial.accelerationX[ id ];
+		frame.accelerationY[ id ] = initial.accelerationY[ id ];
+		frame.spin[ id ]		  = initial.spin[ id ];
+		frame.scaleX[ id ]		  = initial.scaleX[ id ];
+		frame.scaleY[ id ]		  = initial.scaleY[ id ];
+
+		frame.colorR[ id ] = initial.colorR[ id ];
+		frame.colorG[ id ] = initial.colorG[ id ];
+		frame.colorB[ id ] = initial.colorB[ id ];
+		frame.colorA[ id ] = initial.colorA[ id ];
+
+		// What the affector kernels read the age from
+		frame.duration[ id ]  = age;
+		frame.remaining[ id ] = store.lifetime[ id ] - age;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Analytic
+
+//================================================================================
@@ -0,0 +1,31 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "particle-store.h"
+
+//================================================================================
+
+// Particles of analytic patterns are never stepped. Their current columns keep
+// the spawn state and the frame columns are evaluated from age when rendering,
+// see ParticlePattern::analytic.
+namespace Gfx::Particle::Analytic {
+
+//--------------------------------------------------------------------------------
+
+// Clears alive for every particle in [begin, end) that outlived its lifetime at now
+void expire( Store& store, microseconds now, size_t begin, size_t end );
+
+// Fills the frame columns of [begin, end) with the state at now.
+// Constant velocity, acceleration and spin, so motion has a closed form.
+void evaluate( Store& store, microseconds now, size_t begin, size_t end );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Analytic
+
+//================================================================================
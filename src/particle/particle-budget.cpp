@@ -0,0 +1,112 @@
+//================================================================================
+
+#include "particle-budget.h"
+
+//--------------------------------------------------------------------------------
+
+#include <cmath>
+
+#include "debug.h"
+#include "random.h"
+#include "string-utils.h"
+
+//================================================================================
+
+namespace Gfx::Particle::Budget {
+
+//--------------------------------------------------------------------------------
+
+// By lowest importance of the level, never empty
+map< int, Quota > quotas{
+	{ -1, Quota{ 0.5f, false } },
+	{ 0, Quota{ 0.75f, false } },
+	{ 1, Quota{ 1.f, true } },
+};
+
+// Reused by pick, recycling only happens on the main thread
+vector< size_t > candidates;
+
+//================================================================================
+
+void init() {
+	Debug::addCommand(
+		"particle_quota",
+		3u,
+		[]( vector< string > args ) {
+			setQuota( std::stoi( args[ 1 ] ), Quota{ std::stof( args[ 2 ] ), args[ 3 ] == "1" || args[ 3 ] == "true" } );
+		},
+		"particle_quota [importance] [soft fraction] [recycle]" );
+
+	Debug::addCommand(
+		"particle_quotas",
+		[] {
+			for( const auto& [importance, quota] : quotas )
+				Debug::addMessage( Utils::format( "Importance %i: soft %.2f, recycle %s",
+												  importance,
+												  quota.soft,
+												  quota.recycle ? "true" : "false" ),
+								   DebugType::Info );
+		},
+		"Lists the particle budget quotas" );
+}
+
+//--------------------------------------------------------------------------------
+
+void setQuota( int importance, Quota quota ) {
+	quotas[ importance ] = Quota{ std::clamp( quota.soft, 0.f, 1.f ), quota.recycle };
+}
+
+//--------------------------------------------------------------------------------
+
+const Quota& getQuota( int importance ) {
+	auto it = quotas.upper_bound( importance );
+	if( it != quotas.begin() )
+		--it;
+	return it->second;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t scale( const Store& store, int importance, size_t count ) {
+	if( store.limit == 0u )
+		return 0u;
+
+	const Quota& quota = getQuota( importance );
+	const float fill   = float( store.size() ) / float( store.limit );
+	if( fill <= quota.soft || quota.soft >= 1.f )
+		return count;
+
+	// Linear down to nothing at the limit, the fraction rounds randomly so
+	// single particle spawns thin out too
+	const float scaled = float( count ) * std::max( 0.f, 1.f - fill ) / ( 1.f - quota.soft );
+	const float whole  = std::floor( scaled );
+
+	return size_t( whole ) + ( Random::getFloat( 0.f, 1.f ) < scaled - whole ? 1u : 0u );
+}
+
+//--------------------------------------------------------------------------------
+
+void pick( const Store& store, int importance, size_t count, ParticleHandle keep, vector< size_t >& out ) {
+	out.clear();
+
+	const size_t kept = store.resolve( keep );
+
+	candidates.clear();
+	for( size_t i = 0u; i < store.size(); ++i )
+		if( store.importance[ i ] <= importance && i != kept )
+			candidates.push_back( i );
+
+	count = std::min( count, candidates.size() );
+
+	const auto older = [&store]( size_t a, size_t b ) { return store.spawned[ a ] < store.spawned[ b ]; };
+	std::nth_element( candidates.begin(), candidates.begin() + count, candidates.end(), older );
+	std::sort( candidates.begin(), candidates.begin() + count, older );
+
+	out.assign( candidates.begin(), candidates.begin() + count );
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Budget
+
+//================================================================================
@@ -0,0 +1,49 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "particle-store.h"
+
+//================================================================================
+
+// Keeps spawning bounded near a store's particle limit. Every pattern has an
+// importance, see ParticlePattern::importance, and each importance level a
+// Quota. Past its soft share of the limit a level spawns fewer particles, down
+// to none at the limit, and levels that recycle replace the oldest particles
+// of equal or lower importance instead of dropping the spawn.
+namespace Gfx::Particle::Budget {
+
+//--------------------------------------------------------------------------------
+
+struct Quota {
+	// Fraction of the limit where spawn counts start scaling down
+	float soft{ 0.75f };
+	// At the limit, replace old particles instead of spawning fewer
+	bool recycle{ false };
+};
+
+//--------------------------------------------------------------------------------
+
+// Default quotas and the console commands
+void init();
+
+// A level's quota also applies to every importance above it, up to the next level
+void setQuota( int importance, Quota quota );
+const Quota& getQuota( int importance );
+
+// How many of count particles of the given importance the store takes now
+size_t scale( const Store& store, int importance, size_t count );
+
+// Dense indices of up to count particles to recycle for a spawn of the given
+// importance, oldest first. Never picks keep.
+void pick( const Store& store, int importance, size_t count, ParticleHandle keep, vector< size_t >& out );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Budget
+
+//================================================================================
@@ -23,13 +23,21 @@ namespace Gfx::Particle {
 
 struct PatternSet {
 	vector< ParticlePattern > patterns;
+	// Filled by compile(), what get() picks from
+	vector< CompiledPattern > compiled;
 
-	ParticlePattern get() {
-		if( patterns.empty() )
-			return ParticlePattern();
+	void compile() {
+		compiled.clear();
+		for( const ParticlePattern& pattern : patterns )
+			compiled.push_back( pattern.compile() );
+	}
+
+	const CompiledPattern* get() const {
+		if( compiled.empty() )
+			return nullptr;
 
-		const int idx = Random::getInt( 0, ( int )patterns.size() - 1 );
-		return patterns.at( idx );
+		const int idx = Random::getInt( 0, ( int )compiled.size() - 1 );
+		return &compiled.at( idx );
 	}
 
 	rapidjson::Value getValue() {
@@ -52,21 +60,40 @@ struct PatternSet {
 			patterns.push_back( p );
 		}
 	}
+
+	void setValue( json::Stream& in ) {
+		patterns.clear();
+
+		in.readArray( [this, &in] {
+			ParticlePattern p;
+			p.setValue( in );
+			patterns.push_back( p );
+		} );
+	}
 };
 
 //--------------------------------------------------------------------------------
 
 struct PatternSequence {
 	vector< ParticlePattern > patterns;
+	// Filled by compile(), what get() steps through
+	vector< CompiledPattern > compiled;
 	size_t idx = 0u;
 
-	ParticlePattern get() {
-		if( patterns.empty() )
-			return ParticlePattern();
+	void compile() {
+		compiled.clear();
+		for( const ParticlePattern& pattern : patterns )
+			compiled.push_back( pattern.compile() );
+		idx = 0u;
+	}
+
+	const CompiledPattern* get() {
+		if( compiled.empty() )
+			return nullptr;
 
-		ParticlePattern out = patterns.at( idx );
+		const CompiledPattern* out = &compiled.at( idx );
 		idx++;
-		if( idx >= patterns.size() )
+		if( idx >= compiled.size() )
 			idx = 0u;
 		return out;
 	}
@@ -91,11 +118,24 @@ struct PatternSequence {
 			patterns.push_back( p );
 		}
 	}
+
+	void setValue( json::Stream& in ) {
+		patterns.clear();
+
+		in.readArray( [this, &in] {
+			ParticlePattern p;
+			p.setValue( in );
+			patterns.push_back( p );
+		} );
+	}
 };
 
 //--------------------------------------------------------------------------------
 
 struct Emitter {
+	// Transform from the EmitterPattern, before the System's is applied
+	sf::Transformable offset;
+
 	struct {
 		sf::Transformable transform;
 		microseconds duration{ 0 };
@@ -107,11 +147,19 @@ struct Emitter {
 
 	list< shared_ptr< Affector::Affector > > affectors;
 
-	vector< ParticlePattern > patterns;
+	vector< CompiledPattern > patterns;
 	vector< PatternSet > sets;
 	vector< PatternSequence > sequences;
 
-	std::list< Particle* > particles;
+	vector< ParticleHandle > particles;
+	// Set by its System, what its particles refer to it by
+	EmitterHandle handle;
+	// Spawn ages of the current frame, reused
+	vector< microseconds > ages;
+
+	// Particles it may still spawn, including those of its particles' emitters.
+	// Handed down by its System every frame, see System::setBudget.
+	size_t budget{ Store::none };
 
 	bool active{ false };
 
@@ -119,47 +167,110 @@ struct Emitter {
 	void update( sf::Time deltaTime ) {
 
 		// Cleanup
-		auto it = particles.begin();
-		while( it != particles.end() ) {
-			auto temp = it++;
-			if( !( *temp )->alive )
-				particles.erase( temp );
-		}
+		const Store& store = Gfx::Particle::Manager::getStore();
+		particles.erase( std::remove_if( particles.begin(), particles.end(),
+										 [&store]( ParticleHandle handle ) { return !store.valid( handle ); } ),
+						 particles.end() );
 
 		Affector::apply( this, deltaTime );
 
+		step( microseconds( deltaTime.asMicroseconds() ) );
+	}
+
+	// Runs the timers for time and spawns everything that came due in one
+	// batch, aged by how long ago. Spawns older than horizon are skipped, 0
+	// keeps them all.
+	void step( microseconds time, microseconds horizon = 0us ) {
 		if( !active )
 			return;
 
-		current.duration += microseconds( deltaTime.asMicroseconds() );
-		current.delay -= microseconds( deltaTime.asMicroseconds() );
+		// Spawns due longer ago than this came after the emitter ran out
+		const microseconds over = initial.duration > 0ms ? time - remaining : -1us;
 
-		if( current.delay < 0ms ) {
-			spawn();
+		current.duration += time;
+		current.delay -= time;
 
+		ages.clear();
+		while( current.delay < 0ms ) {
 			Math::processSet( current.spawnRate );
-			current.delay = microseconds( int( 1000000.f / current.spawnRate.value ) );
+
+			// Without a rate it spawns once per step
+			if( current.spawnRate.value <= 0.f ) {
+				ages.push_back( 0us );
+				current.delay = 0ms;
+				break;
+			}
+
+			const microseconds age		= -current.delay;
+			const microseconds interval = std::max( microseconds( int64_t( 1000000.f / current.spawnRate.value ) ), 1us );
+
+			// Long gone, straight to the first spawn inside the horizon
+			if( horizon != 0us && age >= horizon ) {
+				current.delay += interval * ( ( age - horizon ) / interval + 1 );
+				continue;
+			}
+
+			if( age > over )
+				ages.push_back( age );
+
+			current.delay += interval;
 		}
 
+		if( !ages.empty() )
+			spawn( ages );
+
 		if( initial.duration >= 0ms ) {
-			remaining -= microseconds( deltaTime.asMicroseconds() );
+			remaining -= time;
 			if( remaining <= 0ms )
 				active = false;
 		}
 	}
 
-	void spawn() {
-		for( ParticlePattern& pattern : patterns )
-			Gfx::Particle::Manager::spawnParticle( pattern, this );
+	// Longest a spawn of any pattern can live, 0 when some never expire
+	microseconds getMaxLifetime() const {
+		vector< microseconds > lifetimes;
+		for( const CompiledPattern& pattern : patterns )
+			lifetimes.push_back( pattern.getMaxLifetime() );
+		for( const PatternSet& set : sets )
+			for( const CompiledPattern& pattern : set.compiled )
+				lifetimes.push_back( pattern.getMaxLifetime() );
+		for( const PatternSequence& sequence : sequences )
+			for( const CompiledPattern& pattern : sequence.compiled )
+				lifetimes.push_back( pattern.getMaxLifetime() );
+
+		if( lifetimes.empty() || std::find( lifetimes.begin(), lifetimes.end(), 0us ) != lifetimes.end() )
+			return 0us;
+		return *std::max_element( lifetimes.begin(), lifetimes.end() );
+	}
 
-		for( PatternSet& set : sets ) {
-			ParticlePattern pattern = set.get();
-			Gfx::Particle::Manager::spawnParticle( pattern, this );
-		}
+	// One batch per pattern for all the spawns, see Manager::spawnParticle
+	void spawn( std::span< const microseconds > ages ) {
+		for( const CompiledPattern& pattern : patterns )
+			Gfx::Particle::Manager::spawnParticle( pattern, this, ages );
+
+		for( PatternSet& set : sets )
+			spawnPicked( ages, [&set] { return set.get(); } );
+
+		for( PatternSequence& sequence : sequences )
+			spawnPicked( ages, [&sequence] { return sequence.get(); } );
+	}
 
-		for( PatternSequence& sequence : sequences ) {
-			ParticlePattern pattern = sequence.get();
-			Gfx::Particle::Manager::spawnParticle( pattern, this );
+	// Sets and sequences pick per spawn, runs of the same pick share a batch
+	template< class F >
+	void spawnPicked( std::span< const microseconds > ages, F pick ) {
+		const CompiledPattern* pattern = ages.empty() ? nullptr : pick();
+		size_t first				   = 0u;
+
+		for( size_t i = 1u; i <= ages.size(); ++i ) {
+			const CompiledPattern* next = i < ages.size() ? pick() : nullptr;
+			if( next == pattern && i < ages.size() )
+				continue;
+
+			if( pattern != nullptr )
+				Gfx::Particle::Manager::spawnParticle( *pattern, this, ages.subspan( first, i - first ) );
+
+			pattern = next;
+			first	= i;
 		}
 	}
 
@@ -179,8 +290,12 @@ struct Emitter {
 	}
 
 	void kill() {
-		for( Particle* particle : particles )
-			particle->dead = true;
+		Store& store = Gfx::Particle::Manager::getStore();
+		for( ParticleHandle handle : particles ) {
+			const size_t particle = store.resolve( handle );
+			if( particle != Store::none )
+				store.dead[ particle ] = true;
+		}
 
 		particles.clear();
 	}
@@ -219,9 +334,16 @@ struct EmitterPattern {
 
 		out.initial.spawnRate = rate;
 
-		out.patterns = patterns;
+		for( const ParticlePattern& pattern : patterns )
+			out.patterns.push_back( pattern.compile() );
+
 		out.sets = sets;
+		for( PatternSet& set : out.sets )
+			set.compile();
+
 		out.sequences = sequences;
+		for( PatternSequence& sequence : out.sequences )
+			sequence.compile();
 
 		for( shared_ptr< Affector::AffectorCreator > affector : affectors )
 			out.affectors.push_back( affector->get() );
@@ -311,6 +433,44 @@ struct EmitterPattern {
 			}
 		}
 	}
+
+	void setValue( json::Stream& in ) {
+		in.readObject( [this, &in]( std::string_view key ) {
+			if( key == "position" )
+				json::getValue( in, position );
+			else if( key == "rotation" )
+				json::getValue( in, rotation );
+			else if( key == "scale" )
+				json::getValue( in, scale );
+			else if( key == "duration" )
+				json::getValue( in, duration );
+			else if( key == "delay" )
+				json::getValue( in, delay );
+			else if( key == "rate" )
+				json::getValue( in, rate );
+			else if( key == "patterns" ) {
+				in.readArray( [this, &in] {
+					ParticlePattern p;
+					p.setValue( in );
+					patterns.push_back( p );
+				} );
+			}
+			else if( key == "sets" ) {
+				in.readArray( [this, &in] {
+					PatternSet s;
+					s.setValue( in );
+					sets.push_back( s );
+				} );
+			}
+			else if( key == "sequences" ) {
+				in.readArray( [this, &in] {
+					PatternSequence s;
+					s.setValue( in );
+					sequences.push_back( s );
+				} );
+			}
+		} );
+	}
 };
 
 //--------------------------------------------------------------------------------
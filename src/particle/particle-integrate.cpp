@@ -0,0 +1,167 @@
+//================================================================================
+
+#include "particle-integrate.h"
+
+//--------------------------------------------------------------------------------
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define TURBINE_X86 1
+#include <immintrin.h>
+#endif
+
+//================================================================================
+
+namespace Gfx::Particle::Integrate {
+
+//--------------------------------------------------------------------------------
+
+// One component of both copies, advanced by a rate column
+struct Axis {
+	float* current;
+	float* frame;
+	const float* rate;
+};
+
+//--------------------------------------------------------------------------------
+
+// current += rate * dt, frame += rate * dt
+void stepScalar( const Axis& axis, size_t begin, size_t count, float dt ) {
+	for( size_t i = begin; i < count; ++i ) {
+		const float step = axis.rate[ i ] * dt;
+		axis.current[ i ] += step;
+		axis.frame[ i ] += step;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+#ifdef TURBINE_X86
+
+void stepSSE2( const Axis& axis, size_t count, float dt ) {
+	const __m128 delta = _mm_set1_ps( dt );
+
+	size_t i = 0u;
+	for( ; i + 4u <= count; i += 4u ) {
+		const __m128 step = _mm_mul_ps( _mm_loadu_ps( axis.rate + i ), delta );
+		_mm_storeu_ps( axis.current + i, _mm_add_ps( _mm_loadu_ps( axis.current + i ), step ) );
+		_mm_storeu_ps( axis.frame + i, _mm_add_ps( _mm_loadu_ps( axis.frame + i ), step ) );
+	}
+
+	stepScalar( axis, i, count, dt );
+}
+
+//--------------------------------------------------------------------------------
+
+__attribute__( ( target( "avx2" ) ) ) void stepAVX2( const Axis& axis, size_t count, float dt ) {
+	const __m256 delta = _mm256_set1_ps( dt );
+
+	size_t i = 0u;
+	for( ; i + 8u <= count; i += 8u ) {
+		const __m256 step = _mm256_mul_ps( _mm256_loadu_ps( axis.rate + i ), delta );
+		_mm256_storeu_ps( axis.current + i, _mm256_add_ps( _mm256_loadu_ps( axis.current + i ), step ) );
+		_mm256_storeu_ps( axis.frame + i, _mm256_add_ps( _mm256_loadu_ps( axis.frame + i ), step ) );
+	}
+
+	stepScalar( axis, i, count, dt );
+}
+
+#endif
+
+//--------------------------------------------------------------------------------
+
+Kernel detect() {
+#ifdef TURBINE_X86
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports( "avx2" ) )
+		return Kernel::AVX2;
+	if( __builtin_cpu_supports( "sse2" ) )
+		return Kernel::SSE2;
+#endif
+	return Kernel::Scalar;
+}
+
+//--------------------------------------------------------------------------------
+
+const Kernel supported = detect();
+Kernel active		   = supported;
+
+//================================================================================
+
+Kernel getSupported() {
+	return supported;
+}
+
+//--------------------------------------------------------------------------------
+
+Kernel getKernel() {
+	return active;
+}
+
+//--------------------------------------------------------------------------------
+
+void setKernel( Kernel kernel ) {
+	active = int( kernel ) <= int( supported ) ? kernel : supported;
+}
+
+//--------------------------------------------------------------------------------
+
+string getName( Kernel kernel ) {
+	switch( kernel ) {
+		case Kernel::Scalar: return "Scalar";
+		case Kernel::SSE2: return "SSE2";
+		case Kernel::AVX2: return "AVX2";
+	}
+	return "";
+}
+
+//--------------------------------------------------------------------------------
+
+void run( PropertyColumns& current, PropertyColumns& frame, size_t count, float dt ) {
+	run( active, current, frame, 0u, count, dt );
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Kernel kernel, PropertyColumns& current, PropertyColumns& frame, size_t count, float dt ) {
+	run( kernel, current, frame, 0u, count, dt );
+}
+
+//--------------------------------------------------------------------------------
+
+void run( PropertyColumns& current, PropertyColumns& frame, size_t begin, size_t end, float dt ) {
+	run( active, current, frame, begin, end, dt );
+}
+
+//--------------------------------------------------------------------------------
+
+void run( Kernel kernel, PropertyColumns& current, PropertyColumns& frame, size_t begin, size_t end, float dt ) {
+	if( end <= begin )
+		return;
+
+	const size_t count = end - begin;
+
+	const auto step = [kernel, count, dt]( const Axis& axis ) {
+		switch( kernel ) {
+#ifdef TURBINE_X86
+			case Kernel::AVX2: stepAVX2( axis, count, dt ); return;
+			case Kernel::SSE2: stepSSE2( axis, count, dt ); return;
+#endif
+			default: stepScalar( axis, 0u, count, dt ); return;
+		}
+	};
+
+	// Velocity goes first, position reads the new frame velocity
+	step( { current.velocityX.data() + begin, frame.velocityX.data() + begin, frame.accelerationX.data() + begin } );
+	step( { current.velocityY.data() + begin, frame.velocityY.data() + begin, frame.accelerationY.data() + begin } );
+
+	step( { current.positionX.data() + begin, frame.positionX.data() + begin, frame.velocityX.data() + begin } );
+	step( { current.positionY.data() + begin, frame.positionY.data() + begin, frame.velocityY.data() + begin } );
+
+	step( { current.rotation.data() + begin, frame.rotation.data() + begin, frame.spin.data() + begin } );
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Integrate
+
+//================================================================================
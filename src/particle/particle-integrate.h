@@ -0,0 +1,50 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "particle-store.h"
+
+//================================================================================
+
+// Velocity / position / spin integration over the packed store columns.
+// The vector kernels are picked at runtime from what the CPU supports.
+namespace Gfx::Particle::Integrate {
+
+//--------------------------------------------------------------------------------
+
+enum class Kernel {
+	Scalar = 0,
+	SSE2,
+	AVX2,
+};
+
+//--------------------------------------------------------------------------------
+
+// Best kernel this CPU supports
+Kernel getSupported();
+
+Kernel getKernel();
+// Falls back to the best supported kernel if the requested one isn't
+void setKernel( Kernel kernel );
+
+string getName( Kernel kernel );
+
+//--------------------------------------------------------------------------------
+
+// Integrates [0, count) of both copies, using frame acceleration/velocity/spin
+void run( PropertyColumns& current, PropertyColumns& frame, size_t count, float dt );
+void run( Kernel kernel, PropertyColumns& current, PropertyColumns& frame, size_t count, float dt );
+
+// Same over [begin, end), ranges don't overlap so they can run on separate threads
+void run( PropertyColumns& current, PropertyColumns& frame, size_t begin, size_t end, float dt );
+void run( Kernel kernel, PropertyColumns& current, PropertyColumns& frame, size_t begin, size_t end, float dt );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Integrate
+
+//================================================================================
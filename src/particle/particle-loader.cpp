@@ -4,6 +4,9 @@
 
 //--------------------------------------------------------------------------------
 
+#include <filesystem>
+
+#include "binary.h"
 #include "json.h"
 #include "string-utils.h"
 
@@ -15,20 +18,50 @@ namespace Gfx::Particle::Loader {
 
 //--------------------------------------------------------------------------------
 
-map< string, ParticlePattern > patterns;
+// Bump on any change to ParticlePattern::write
+constexpr uint32_t version = 3u;
+
+const Binary::Header header{
+	{ 'T', 'P', 'A', 'T' },
+	version,
+	uint32_t( sizeof( Math::ValueSet< Math::Color > ) ^ ( sizeof( Math::Position ) << 8 )
+			  ^ ( sizeof( Math::Velocity ) << 16 ) ^ ( sizeof( Inheritance ) << 24 ) ),
+};
+
+map< string, CompiledPattern > patterns;
 
 //================================================================================
 
-ParticlePattern* get( string path ) {
-	if( patterns.count( path ) )
-		return &patterns[ path ];
+bool isCurrent( const string& binary, const string& source ) {
+	std::error_code error;
+	if( !std::filesystem::exists( binary, error ) )
+		return false;
+	if( !std::filesystem::exists( source, error ) )
+		return true;
 
-	ParticlePattern pattern;
-	if( !json::load( [&pattern]( const rapidjson::Value& value ) { return pattern.setValue( value ); }, path ) )
-		Debug::addMessage( Utils::format( "%s failed to load", path.c_str() ), DebugType::Error );
+	return std::filesystem::last_write_time( binary, error ) >= std::filesystem::last_write_time( source, error );
+}
+
+//--------------------------------------------------------------------------------
+
+const CompiledPattern* get( string path ) {
+	const auto it = patterns.find( path );
+	if( it != patterns.end() )
+		return &it->second;
 
-	patterns[ path ] = pattern;
-	return &patterns[ path ];
+	// Added before compiling, so patterns that emit themselves resolve to it
+	CompiledPattern& out = patterns[ path ];
+
+	ParticlePattern pattern;
+	const string binary = getBinaryPath( path );
+	if( !isCurrent( binary, path ) || !loadBinary( binary, pattern ) ) {
+		pattern = ParticlePattern();
+		if( !json::load( [&pattern]( json::Stream& in ) { return pattern.setValue( in ); }, path ) )
+			Debug::addMessage( Utils::format( "%s failed to load", path.c_str() ), DebugType::Error );
+	}
+
+	out = pattern.compile();
+	return &out;
 }
 
 //--------------------------------------------------------------------------------
@@ -39,6 +72,54 @@ void unload() {
 
 //--------------------------------------------------------------------------------
 
+string getBinaryPath( const string& path ) {
+	return std::filesystem::path( path ).replace_extension( ".tpat" ).string();
 }
 
-//================================================================================
\ No newline at end of file
+//--------------------------------------------------------------------------------
+
+bool saveBinary( const ParticlePattern& pattern, const string& path ) {
+	Binary::Writer writer( header );
+	pattern.write( writer );
+
+	if( !writer.save( path ) ) {
+		Debug::addMessage( Utils::format( "%s failed to save", path.c_str() ), DebugType::Error );
+		return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+bool loadBinary( const string& path, ParticlePattern& out ) {
+	Binary::MappedFile file;
+	if( !file.open( path ) )
+		return false;
+
+	Binary::Reader reader( file.getData(), header );
+	if( !out.read( reader ) ) {
+		Debug::addMessage( Utils::format( "%s is out of date or damaged", path.c_str() ), DebugType::Warning );
+		return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+bool convert( const string& path ) {
+	ParticlePattern pattern;
+	if( !json::load( [&pattern]( json::Stream& in ) { return pattern.setValue( in ); }, path ) ) {
+		Debug::addMessage( Utils::format( "%s failed to load", path.c_str() ), DebugType::Error );
+		return false;
+	}
+
+	return saveBinary( pattern, getBinaryPath( path ) );
+}
+
+//--------------------------------------------------------------------------------
+
+}
+
+//================================================================================
@@ -12,6 +12,7 @@ namespace Gfx::Particle {
 
 //--------------------------------------------------------------------------------
 
+struct CompiledPattern;
 struct ParticlePattern;
 
 //--------------------------------------------------------------------------------
@@ -20,13 +21,23 @@ namespace Loader {
 
 //--------------------------------------------------------------------------------
 
-ParticlePattern* get( string path );
+// Loaded and compiled once, the pointer stays valid until unload().
+// Uses the binary next to path when it's at least as new as the JSON.
+const CompiledPattern* get( string path );
 
 void unload();
 
+// Binary pattern files, a header followed by ParticlePattern::write
+string getBinaryPath( const string& path );
+bool saveBinary( const ParticlePattern& pattern, const string& path );
+bool loadBinary( const string& path, ParticlePattern& out );
+
+// Writes the binary for the JSON pattern at path
+bool convert( const string& path );
+
 //--------------------------------------------------------------------------------
 
 }
 }
 
-//================================================================================
\ No newline at end of file
+//================================================================================
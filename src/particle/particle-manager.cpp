@@ -4,12 +4,19 @@
 
 //--------------------------------------------------------------------------------
 
+#include "atlas.h"
 #include "debug.h"
+#include "jobs.h"
 #include "system.h"
 
+#include "particle-analytic.h"
+#include "particle-budget.h"
 #include "particle-emitter.h"
+#include "particle-integrate.h"
+#include "particle-vertices.h"
 #include "particle-system.h"
 #include "particle-affector-manager.h"
+#include "particle-affector-batch.h"
 
 #include "string-utils.h"
 
@@ -23,12 +30,11 @@ struct RenderGroup {
 	bool active{ false };
 	RenderProperties properties;
 	sf::Color color{ sf::Color::White };
-	list< Particle* > particles;
+	// Live particles in the group, recounted after every compaction
+	size_t count{ 0u };
 
 	bool operator==( const RenderProperties& rh ) {
-		return active 
-			&& properties.priority == rh.priority
-			&& properties.texture == rh.texture;
+		return active && properties == rh;
 	}
 	bool operator<( const RenderGroup& rh ) {
 		return properties.priority < rh.properties.priority;
@@ -40,7 +46,6 @@ struct RenderGroup {
 
 //--------------------------------------------------------------------------------
 
-constexpr size_t globalParticleLimit = 100000u;
 constexpr size_t globalGroupLimit = 128u;
 static const array< sf::Color, 8u > debugColors{ {
 		sf::Color::White,
@@ -55,107 +60,246 @@ static const array< sf::Color, 8u > debugColors{ {
 array< RenderGroup, 128u > groups;
 stack< size_t > groupIDs;
 
-array< Particle, globalParticleLimit > particles;
-stack< size_t > particleIDs;
-stack< size_t > fullParticleIDs;
-size_t particleCount{ 0u };
+// Per group GPU storage, kept when a group ID is recycled so the
+// reserved buffers carry over
+struct RenderBuffer {
+	sf::VertexBuffer quads{ sf::Quads, sf::VertexBuffer::Stream };
+	vector< sf::Vertex > vertices;
+	vector< sf::Vertex > outlines;
+	// Quads built this frame
+	size_t count{ 0u };
+};
+
+// Made on a group's first draw, so no GL resource exists before the context
+// or outlives shutdown()
+array< unique_ptr< RenderBuffer >, 128u > buffers;
+
+// Visible dense indices of one store sorted by group, each group draws a contiguous slice
+struct RenderList {
+	// Per dense index, set by the culling pass
+	vector< uint8_t > visible;
+	vector< size_t > indices;
+	array< size_t, 129u > offsets;
+
+	void build( const Store& source, bool cull, const sf::FloatRect& bounds );
+
+	size_t count( size_t group ) const { return offsets[ group + 1u ] - offsets[ group ]; }
+	const size_t* get( size_t group ) const { return indices.data() + offsets[ group ]; }
+};
+
+RenderList renderList;
+RenderList analyticList;
+
+bool culling{ true };
+size_t visibleCount{ 0u };
+
+// Set by fastForward, see setCatchingUp
+bool catchingUp{ false };
+
+// World area of the last view vertices were built for, see isVisible
+sf::FloatRect viewBounds;
+bool viewKnown{ false };
+
+// Particles per job in the parallel passes
+constexpr size_t chunkSize = 4096u;
+
+// Spawns requested by affectors while jobs are running
+struct SpawnRequest {
+	const CompiledPattern* pattern;
+	ParticleHandle parent;
+	microseconds age;
+};
+
+// One queue per job thread, merged on the main thread
+vector< vector< SpawnRequest > > spawnQueues;
+vector< SpawnRequest > pendingSpawns;
+vector< microseconds > pendingAges;
+
+// Children with affectors or an attached lifetime sorted by depth,
+// level d is [levels[ d ], levels[ d + 1 ])
+vector< size_t > childIndices;
+vector< size_t > levels;
+vector< size_t > levelCursors;
+
+// Slot -> registered emitter / generation, see addEmitter
+vector< Emitter* > emitters;
+vector< uint32_t > emitterGenerations;
+vector< uint32_t > freeEmitterSlots;
+
+// Reused by every spawn, spawning only happens on the main thread
+SpawnRolls rolls;
+vector< size_t > victims;
+// Particles per spawn of a batch
+vector< int > spawnTotals;
+
+// Seeds the per-chunk random streams of the parallel passes
+uint64_t frameIndex{ 0u };
+
+// Time since init, analytic particles are evaluated against it
+microseconds elapsed{ 0 };
 
 //================================================================================
 
-void init() {
-	for( size_t i = globalParticleLimit; i != 0; --i )
-		fullParticleIDs.push( i - 1u );
-	particleIDs = fullParticleIDs;
+void flushSpawns();
+void buildLevels( size_t count );
+bool isLinked( size_t index );
+void followParent( size_t index );
+
+Store store;
+// Particles of analytic patterns, never stepped, see Analytic
+Store analytic;
+
+//================================================================================
+
+void init( size_t particleLimit ) {
+	store.init( particleLimit );
+	analytic.init( particleLimit );
+	spawnQueues.resize( Jobs::getThreadCount() );
+
 	for( size_t i = globalGroupLimit; i != 0; --i )
 		groupIDs.push( i - 1u );
 
-	particles.fill( Particle() );
-
 	Debug::addPerformancePage( "Particles",
 							   [] {
 								   string out;
 
 								   out = Utils::format(
 									   "Particles: %i\n"
+									   "Analytic: %i\n"
 									   "Groups: %i\n"
 									   "\n"
 									   "Next Particle ID: %i\n"
 									   "Next Group ID: %i\n"
 									   "\n"
-									   "Global Particle Limit: %i\n"
-									   "Global Group Limit: %i\n",
-									   particleCount,
+									   "Particle Limit: %i\n"
+									   "Particle Capacity: %i\n"
+									   "Analytic Limit: %i\n"
+									   "Analytic Capacity: %i\n"
+									   "Global Group Limit: %i\n"
+									   "\n"
+									   "Visible: %i\n"
+									   "Atlas Pages: %i\n"
+									   "Integration: %s\n",
+									   store.size(),
+									   analytic.size(),
 									   std::count( groups.begin(), groups.end(), true ),
-									   particleIDs.top(),
+									   store.freeSlots.empty() ? store.capacity() : store.freeSlots.back(),
 									   groupIDs.top(),
-									   globalParticleLimit,
-									   globalGroupLimit
+									   store.limit,
+									   store.capacity(),
+									   analytic.limit,
+									   analytic.capacity(),
+									   globalGroupLimit,
+									   visibleCount,
+									   Atlas::getPageCount(),
+									   Integrate::getName( Integrate::getKernel() ).c_str()
 								   );
 
 								   return out;
 							   } );
+
+	Budget::init();
+
+	Debug::addSetCommand( "particle_culling", culling, "Skip particles outside the view when rendering" );
+	Debug::addSetCommand( "particle_limit", store.limit, "Maximum simulated particles, the pool grows up to it" );
+	Debug::addSetCommand( "analytic_limit", analytic.limit, "Maximum analytic particles, the pool grows up to it" );
 }
 
 //--------------------------------------------------------------------------------
 
 void update( sf::Time delta ) {
-	if( particleCount == 0u )
+	if( store.size() == 0u && analytic.size() == 0u )
 		return;
 
 	Debug::startTimer( "Particle - Update" );
 
-	size_t processedParticles = 0u;
+	const microseconds dt = microseconds( delta.asMicroseconds() );
+	elapsed += dt;
 
-	for( size_t i = 0; i < particles.size(); ++i ) {
-		if( !particles.at( i ).alive )
-			continue;
+	// Analytic particles only need their lifetime checked
+	Jobs::parallelFor( analytic.size(), chunkSize, []( size_t begin, size_t end ) {
+		Analytic::expire( analytic, elapsed, begin, end );
+	} );
+
+	// Particles spawned by affectors are appended to the dense range
+	// and get their first update next frame
+	const size_t count = store.size();
 
-		Particle& particle = particles.at( i );
+	Jobs::parallelFor( count, chunkSize, [dt]( size_t begin, size_t end ) {
+		for( size_t i = begin; i < end; ++i ) {
 
-		// Handle lifetime
-		particle.current.duration += microseconds( delta.asMicroseconds() );
+			// Handle lifetime
+			store.current.duration[ i ] += dt;
 
-		if( particle.initial.remaining > 0ms ) {
-			particle.current.remaining -= microseconds( delta.asMicroseconds() );
+			if( store.lifetime[ i ] > 0ms ) {
+				store.current.remaining[ i ] -= dt;
 
-			// Particle is dead
-			if( particle.current.remaining <= 0ms )
-				particle.alive = false;
+				// Particle is dead
+				if( store.current.remaining[ i ] <= 0ms )
+					store.alive[ i ] = false;
+			}
+			if( store.dead[ i ] )
+				store.alive[ i ] = false;
 		}
-		if( particle.dead )
-			particle.alive = false;
 
-		particle.frame = particle.current;
+		store.frame.copy( store.current, begin, end );
+	} );
+
+	// Batched affectors first, they come before emitters and inheritance in a pattern
+	Affector::runTables( store );
+
+	// Affectors only touch their own particle, except inheritance which reads
+	// the parent's frame. Children run a level at a time after their parents.
+	buildLevels( count );
+
+	// Chunks draw from their own stream, so results don't depend on the thread
+	frameIndex++;
+	Jobs::parallelFor( count, chunkSize, [delta]( size_t begin, size_t end ) {
+		Random::Stream stream = Random::makeStream( ( frameIndex << 32 ) + begin / chunkSize );
+		Random::ScopedStream scope( stream );
+
+		for( size_t i = begin; i < end; ++i )
+			if( store.parent[ i ] == ParticleHandle() && store.hasAffectors( i ) )
+				Affector::apply( store, i, delta );
+	} );
+
+	for( size_t level = 0u; level + 1u < levels.size(); ++level ) {
+		const size_t first = levels[ level ];
+		Jobs::parallelFor( levels[ level + 1u ] - first, chunkSize, [delta, first, level]( size_t begin, size_t end ) {
+			Random::Stream stream = Random::makeStream( ( frameIndex << 32 ) + ( uint64_t( level ) << 24 ) + begin / chunkSize );
+			Random::ScopedStream scope( stream );
+
+			for( size_t i = first + begin; i < first + end; ++i ) {
+				const size_t child = childIndices[ i ];
+				followParent( child );
+				if( store.hasAffectors( child ) )
+					Affector::apply( store, child, delta );
+			}
+		} );
+	}
 
-		if( !particle.affectors.empty() )
-			Affector::apply( &particle, delta );
+	// Before compacting, so dying parents still resolve
+	flushSpawns();
 
-		if( !particle.alive ) {
-			particleIDs.push( i );
-			particleCount--;
-			processedParticles--;
-		}
+	store.compact();
+	Affector::sweepTables( store );
 
-		processedParticles++;
-		if( processedParticles == particleCount )
-			break;
-	}
+	analytic.compact();
+	Affector::sweepTables( Affector::getAnalyticTables(), analytic );
 
 	Debug::stopTimer( "Particle - Update" );
 
 	Debug::startTimer( "Particle - Cleanup Groups" );
-	for( size_t i = 0; i < groups.size(); ++i ) {
-		if( !( groups.at( i ).active ) )
-			continue;
+	for( RenderGroup& group : groups )
+		group.count = 0u;
 
-		auto it = groups.at( i ).particles.begin();
-		while( it != groups.at( i ).particles.end() ) {
-			auto temp = it++;
-			if( !( *temp )->alive )
-				groups.at( i ).particles.erase( temp );
-		}
+	for( size_t i = 0u; i < store.size(); ++i )
+		groups[ store.group[ i ] ].count++;
+	for( size_t i = 0u; i < analytic.size(); ++i )
+		groups[ analytic.group[ i ] ].count++;
 
-		if( groups.at( i ).particles.empty() ) {
+	for( size_t i = 0; i < groups.size(); ++i ) {
+		if( groups.at( i ).active && groups.at( i ).count == 0u ) {
 			groups.at( i ).active = false;
 			groupIDs.push( i );
 		}
@@ -165,96 +309,189 @@ void update( sf::Time delta ) {
 
 //--------------------------------------------------------------------------------
 
+// Counting sort of the linked children in [0, count) by depth, dense order
+// within a level
+void buildLevels( size_t count ) {
+	levels.assign( 2u, 0u );
+	for( size_t i = 0u; i < count; ++i ) {
+		if( !isLinked( i ) )
+			continue;
+
+		const size_t depth = store.depth[ i ];
+		if( depth + 2u > levels.size() )
+			levels.resize( depth + 2u, 0u );
+		levels[ depth + 1u ]++;
+	}
+
+	for( size_t level = 1u; level < levels.size(); ++level )
+		levels[ level ] += levels[ level - 1u ];
+
+	childIndices.resize( levels.back() );
+	levelCursors.assign( levels.begin(), levels.end() - 1 );
+
+	for( size_t i = 0u; i < count; ++i )
+		if( isLinked( i ) )
+			childIndices[ levelCursors[ store.depth[ i ] ]++ ] = i;
+}
+
+//--------------------------------------------------------------------------------
+
+// Children that read their parent every frame
+bool isLinked( size_t index ) {
+	return store.parent[ index ] != ParticleHandle() && ( store.attached[ index ] || store.hasAffectors( index ) );
+}
+
+//--------------------------------------------------------------------------------
+
+// Attached children die with their parent, levels run top down so a whole
+// branch goes in the same frame. The rest are detached once the parent is
+// removed, so nothing resolves its handle again.
+void followParent( size_t index ) {
+	const size_t parent = store.resolve( store.parent[ index ] );
+	if( parent != Store::none && store.alive[ parent ] )
+		return;
+
+	if( store.attached[ index ] )
+		store.alive[ index ] = false;
+	else if( parent == Store::none )
+		store.parent[ index ] = ParticleHandle();
+}
+
+//--------------------------------------------------------------------------------
+
 void postUpdate( sf::Time delta ) {
 	Debug::startTimer( "Particle - Post Update" );
 	const float dt = delta.asSeconds();
 
-	size_t processedParticles = 0u;
-	for( Particle& particle : particles ) {
-		if( particle.alive ) {
-			particle.current.velocity += particle.frame.acceleration * dt;
-			particle.frame.velocity += particle.frame.acceleration * dt;
+	Jobs::parallelFor( store.size(), chunkSize, [dt]( size_t begin, size_t end ) {
+		Integrate::run( store.current, store.frame, begin, end, dt );
+	} );
 
-			particle.current.transform.move( particle.frame.velocity.sf() * dt );
-			particle.frame.transform.move( particle.frame.velocity.sf() * dt );
+	Debug::stopTimer( "Particle - Post Update" );
+}
 
-			particle.current.transform.rotate( particle.frame.spin * dt );
-			particle.frame.transform.rotate( particle.frame.spin * dt );
+//--------------------------------------------------------------------------------
 
-			processedParticles++;
-			if( processedParticles == particleCount )
-				break;
-		}
+void RenderList::build( const Store& source, bool cull, const sf::FloatRect& bounds ) {
+	visible.resize( source.size() );
+	if( cull ) {
+		Jobs::parallelFor( source.size(), chunkSize, [this, &source, &bounds]( size_t begin, size_t end ) {
+			Vertices::cull( source, begin, end, bounds, visible.data() );
+		} );
+	}
+	else
+		std::fill( visible.begin(), visible.end(), uint8_t( 1u ) );
+
+	// Counting sort of the visible part of the dense range by group
+	array< size_t, 128u > cursors{};
+	// Dead ones wait for the next update to be removed, they're not drawn
+	for( size_t i = 0u; i < source.size(); ++i ) {
+		visible[ i ] = visible[ i ] && !source.dead[ i ];
+		cursors[ source.group[ i ] ] += visible[ i ];
 	}
 
-	Debug::stopTimer( "Particle - Post Update" );
+	offsets[ 0 ] = 0u;
+	for( size_t group = 0u; group < cursors.size(); ++group ) {
+		offsets[ group + 1u ] = offsets[ group ] + cursors[ group ];
+		cursors[ group ]	  = offsets[ group ];
+	}
+
+	indices.resize( offsets.back() );
+	for( size_t i = 0u; i < source.size(); ++i )
+		if( visible[ i ] )
+			indices[ cursors[ source.group[ i ] ]++ ] = i;
 }
 
 //--------------------------------------------------------------------------------
 
-void render( sf::RenderTarget* target ) {
-	 Debug::startTimer( "Particle - Render" );
-	 for( size_t group = 0u; group < groups.size(); ++group ) {
-		 if( !groups.at( group ).active )
-			 continue;
+void buildVertices( const sf::View& view ) {
+	Debug::startTimer( "Particle - Build Vertices" );
+
+	// Analytic particles are only ever evaluated here
+	Jobs::parallelFor( analytic.size(), chunkSize, []( size_t begin, size_t end ) {
+		Analytic::evaluate( analytic, elapsed, begin, end );
+	} );
+	Affector::runTables( Affector::getAnalyticTables(), analytic );
+
+	// Everything is simulated, only what the view shows gets vertices
+	const sf::FloatRect bounds = Vertices::getBounds( view );
+	viewBounds				   = bounds;
+	viewKnown				   = true;
+	renderList.build( store, culling, bounds );
+	analyticList.build( analytic, culling, bounds );
+
+	visibleCount = 0u;
+	for( size_t group = 0u; group < groups.size(); ++group ) {
+		const size_t simulated = renderList.count( group );
+		const size_t count	   = groups.at( group ).active ? simulated + analyticList.count( group ) : 0u;
+
+		unique_ptr< RenderBuffer >& slot = buffers.at( group );
+		if( slot == nullptr ) {
+			if( count == 0u )
+				continue;
+			slot = make_unique< RenderBuffer >();
+		}
 
-		sf::RenderStates states;
-		states.texture = &Sprite::get( groups.at( group ).properties.texture );
-		states.blendMode = sf::BlendAdd;
+		RenderBuffer& buffer = *slot;
+		buffer.count		 = count;
+		if( buffer.count == 0u )
+			continue;
 
-		sf::Vector2u textureSize = states.texture->getSize();
+		visibleCount += buffer.count;
 
-		sf::VertexArray vertexArray;
-		sf::VertexArray debugVertexArray;
-		bool debug = ::System::getSystemInfo().drawDebug;
+		const size_t vertexCount = buffer.count * Vertices::perQuad;
+		if( buffer.vertices.size() < vertexCount )
+			buffer.vertices.resize( vertexCount );
 
-		for( Particle* particle : groups.at( group ).particles ) {
-			if( !particle->alive )
-				continue;
+		Vertices::buildQuads( store, renderList.get( group ), simulated, buffer.vertices.data() );
+		Vertices::buildQuads( analytic,
+							  analyticList.get( group ),
+							  analyticList.count( group ),
+							  buffer.vertices.data() + simulated * Vertices::perQuad );
+	}
 
-			sf::Vertex vertex;
+	Debug::stopTimer( "Particle - Build Vertices" );
+}
 
-			sf::Transform transform = particle->frame.transform.getTransform();
+//--------------------------------------------------------------------------------
 
-			std::array< sf::Vector2f, 4u > vertices = { {
-				{ sf::Vector2f( 0.f, 0.f ) },
-				{ sf::Vector2f( 1.f, 0.f ) },
-				{ sf::Vector2f( 1.f, 1.f ) },
-				{ sf::Vector2f( 0.f, 1.f ) }
-			} };
+void render( sf::RenderTarget* target ) {
+	buildVertices( target->getView() );
 
-			for( sf::Vector2f v : vertices ) {
-				vertex.position = transform.transformPoint( v );
-				vertex.color = particle->frame.color.sf();
-				vertex.texCoords = sf::Vector2f( v.x * textureSize.x, v.y * textureSize.y );
-				vertexArray.append( vertex );
-			}
+	Debug::startTimer( "Particle - Render" );
 
-			if( debug ) {
-				function< void( sf::Vector2f ) > makeVertex = [&debugVertexArray, &transform, &vertex, &group]( sf::Vector2f v ) {
-					vertex.position = transform.transformPoint( v );
-					vertex.color = groups.at( group ).color;
-					debugVertexArray.append( vertex );
-				};
-
-				makeVertex( vertices[ 0 ] );
-				makeVertex( vertices[ 1 ] );
-				makeVertex( vertices[ 1 ] );
-				makeVertex( vertices[ 2 ] );
-				makeVertex( vertices[ 2 ] );
-				makeVertex( vertices[ 3 ] );
-				makeVertex( vertices[ 3 ] );
-				makeVertex( vertices[ 0 ] );
-			}
-		}
+	for( size_t group = 0u; group < groups.size(); ++group ) {
+		if( buffers.at( group ) == nullptr || buffers.at( group )->count == 0u )
+			continue;
+
+		RenderBuffer& buffer = *buffers.at( group );
+
+		sf::RenderStates states;
+		states.texture = &Atlas::getPage( groups.at( group ).properties.page );
+		states.blendMode = groups.at( group ).properties.blend;
 
-		vertexArray.setPrimitiveType( sf::PrimitiveType::Quads );
-		target->draw( vertexArray, states );
+		const size_t vertexCount = buffer.count * Vertices::perQuad;
+
+		// Grow the GPU buffer geometrically, it is only reallocated when the group outgrows it
+		if( sf::VertexBuffer::isAvailable() ) {
+			if( buffer.quads.getVertexCount() < vertexCount )
+				buffer.quads.create( std::max( vertexCount, buffer.quads.getVertexCount() * 2u ) );
+
+			buffer.quads.update( buffer.vertices.data(), vertexCount, 0u );
+			target->draw( buffer.quads, 0u, vertexCount, states );
+		}
+		else
+			target->draw( buffer.vertices.data(), vertexCount, sf::Quads, states );
 		Debug::incDrawCall();
 
-		if( debug ) {
-			debugVertexArray.setPrimitiveType( sf::Lines );
-			target->draw( debugVertexArray );
+		if( ::System::getSystemInfo().drawDebug ) {
+			const size_t outlineCount = buffer.count * Vertices::perOutline;
+			if( buffer.outlines.size() < outlineCount )
+				buffer.outlines.resize( outlineCount );
+
+			Vertices::buildOutlines( buffer.vertices.data(), buffer.count, groups.at( group ).color, buffer.outlines.data() );
+
+			target->draw( buffer.outlines.data(), outlineCount, sf::Lines );
 			Debug::incDrawCall();
 		}
 	}
@@ -264,25 +501,23 @@ void render( sf::RenderTarget* target ) {
 //--------------------------------------------------------------------------------
 
 void clearAll() {
-	 if( particleCount == 0u )
+	 for( vector< SpawnRequest >& queue : spawnQueues )
+		 queue.clear();
+
+	 if( store.size() == 0u && analytic.size() == 0u )
 		 return;
 
-	 size_t processedParticles = 0u;
-	 for( Particle& particle : particles ) {
-		 if( !particle.alive )
-			 continue;
-		 particle.alive = false;
-		 processedParticles++;
+	 store.clear();
+	 Affector::clearTables();
 
-		 if( processedParticles == particleCount )
-			 break;
-	 }
-	 for( RenderGroup& group : groups )
-		 group.particles.clear();
+	 analytic.clear();
+	 Affector::clearTables( Affector::getAnalyticTables() );
 
-	 particleCount = 0u;
+	 for( RenderGroup& group : groups ) {
+		 group.active = false;
+		 group.count  = 0u;
+	 }
 
-	 particleIDs = fullParticleIDs;
 	 groupIDs = stack< size_t >();
 	 for( size_t i = globalGroupLimit; i != 0; --i )
 		 groupIDs.push( i - 1u );
@@ -290,12 +525,25 @@ void clearAll() {
 
 //--------------------------------------------------------------------------------
 
+void shutdown() {
+	clearAll();
+
+	for( unique_ptr< RenderBuffer >& buffer : buffers )
+		buffer.reset();
+}
+
+//--------------------------------------------------------------------------------
+
+// Store::none when every group is taken
 size_t getGroupID( RenderProperties properties ) {
 	size_t out;
 
 	const auto it = std::find( groups.begin(), groups.end(), properties );
 
 	if( it == groups.end() ) {
+		if( groupIDs.empty() )
+			return Store::none;
+
 		RenderGroup group;
 		group.properties = properties;
 		group.active = true;
@@ -318,124 +566,289 @@ size_t getGroupID( RenderProperties properties ) {
 
 //--------------------------------------------------------------------------------
 
-list< Particle* > spawnParticle( ParticlePattern pattern, sf::Transformable parentTransform ) {
-	list< Particle* > out;
+// Makes room for count particles of the given importance by releasing the
+// oldest ones of equal or lower importance, when its quota recycles
+void recycle( Store& target, int importance, size_t count, ParticleHandle keep ) {
+	const size_t free = target.full() ? 0u : target.limit - target.size();
+	if( count <= free || !Budget::getQuota( importance ).recycle )
+		return;
 
-	Math::processSet( pattern.number );
-	if( pattern.number.value == 0 )
-		return out;
+	// A batch at once, so a burst of spawns doesn't rescan the store every time
+	Budget::pick( target, importance, std::max( count - free, target.limit / 256u ), keep, victims );
 
-	RenderProperties properties;
-	properties.priority = pattern.priority;
-	properties.texture = Sprite::get( pattern.texture );
+	// Highest first, so the particle swapped in is never a victim
+	std::sort( victims.begin(), victims.end(), std::greater<>() );
+	for( size_t i : victims ) {
+		groups[ target.group[ i ] ].count--;
+		target.release( i );
+	}
+}
 
-	size_t gId = getGroupID( properties );
+//--------------------------------------------------------------------------------
+
+// Reserves every particle of the pattern at once and builds them in place,
+// one spawn per age, see spawnParticle.
+// At most quota particles, fewer near the limit, see Budget. keep is never recycled.
+ParticleRange spawnBatch( const CompiledPattern& pattern,
+						 bool child,
+						 size_t quota,
+						 ParticleHandle keep,
+						 std::span< const microseconds > ages,
+						 const function< Particle( int index, int total, const SpawnRolls& rolls ) >& make ) {
+	static const microseconds now[] = { 0us };
+	if( ages.empty() )
+		ages = now;
+
+	size_t total = 0u;
+	spawnTotals.clear();
+	for( size_t spawn = 0u; spawn < ages.size(); ++spawn ) {
+		spawnTotals.push_back( std::max( pattern.rollNumber(), 0 ) );
+		total += size_t( spawnTotals.back() );
+	}
 
-	for( int i = 0; i < pattern.number.value; ++i ) {
-		Particle particle = pattern.process( i, pattern.number.value );
+	if( total == 0u )
+		return ParticleRange();
 
-		particle.group = gId;
-		particle.alive = true;
+	Store& target	   = pattern.analytic ? analytic : store;
+	const size_t count = std::min( Budget::scale( target, pattern.importance, total ), quota );
+	if( count == 0u )
+		return ParticleRange();
 
-		const size_t pId = particleIDs.top();
-		particleIDs.pop();
-		
-		particles.at( pId ) = particle;
-		out.push_back( &particles.at( pId ) );
-		particleCount++;
+	const size_t gId = getGroupID( pattern.properties );
+	if( gId == Store::none )
+		return ParticleRange();
 
-		Affector::apply( &particle, sf::Time::Zero );
+	recycle( target, pattern.importance, count, keep );
+
+	ParticleRange range = target.allocate( count );
+	if( range.empty() )
+		return range;
+
+	const shared_ptr< const AffectorList >& shared = child ? pattern.sharedChild : pattern.shared;
+
+	// In order, so when the range falls short the latest spawns are cut
+	size_t i = range.first;
+	for( size_t spawn = 0u; spawn < ages.size() && i < range.last; ++spawn ) {
+		const int total		   = spawnTotals[ spawn ];
+		const microseconds age = ages[ spawn ];
+		pattern.roll( rolls, total );
+
+		for( int index = 0; index < total && i < range.last; ++index ) {
+			Particle particle		 = make( index, total, rolls );
+			particle.sharedAffectors = shared;
+
+			// Came due and expired since. Only spawned for its on death emitters,
+			// and not when catching up, those would all go off at once.
+			const microseconds lifetime = particle.initial.remaining;
+			const bool expired			= lifetime > 0ms && age >= lifetime;
+			if( expired && ( catchingUp || !pattern.shared ) )
+				continue;
+
+			// Nothing attached, the parent was only read at spawn.
+			// Analytic ones take their age from spawned instead.
+			if( pattern.analytic ) {
+				particle.parent	  = ParticleHandle();
+				particle.attached = false;
+				particle.emitter  = EmitterHandle();
+			}
+			else
+				particle.initial.advance( age );
+
+			// set() takes the lifetime from remaining, which advance shortened
+			target.set( i, std::move( particle ), gId, pattern.texCoords );
+			target.lifetime[ i ]   = lifetime;
+			target.spawned[ i ]	   = elapsed - age;
+			target.importance[ i ] = pattern.importance;
+
+			// Killed by the next update, so its on death emitters fire once
+			// whether it was spawned inside an update or not
+			target.dead[ i ] = expired;
+			++i;
+		}
 	}
 
-	groups.at( gId ).particles.insert( groups.at( gId ).particles.end(), out.begin(), out.end() );
+	// Hand back what expired spawns left unused, it's the tail so nothing moves
+	for( size_t last = range.last; last > i; --last )
+		target.release( last - 1u );
+	range.last = i;
 
-	return out;
-}
+	groups.at( gId ).count += range.size();
 
-//--------------------------------------------------------------------------------
+	// Rows only, they run when the particles are evaluated
+	if( pattern.analytic ) {
+		Affector::TableLayer layer{ 0u };
+		for( const shared_ptr< Affector::AffectorCreator >& creator : pattern.batched )
+			creator->add( Affector::getAnalyticTables(), layer, analytic, range );
+		return range;
+	}
 
-list< Particle* > spawnParticle( ParticlePattern pattern, Particle* parent ) {
-	list< Particle* > out;
+	const Affector::TableMark mark = Affector::markTables();
 
-	Math::processSet( pattern.number );
+	Affector::TableLayer layer{ 0u };
+	for( const shared_ptr< Affector::AffectorCreator >& creator : pattern.batched )
+		creator->add( Affector::getTables(), layer, store, range );
 
-	RenderProperties properties;
-	properties.priority = pattern.priority;
-	properties.texture = Sprite::get( pattern.texture );
+	// Zero-delta pass so the first frame already shows the affected state
+	Affector::runTables( store, mark );
+	for( size_t i = range.first; i < range.last; ++i )
+		Affector::apply( store, i, sf::Time::Zero );
+
+	return range;
+}
 
-	size_t gId = getGroupID( properties );
+//--------------------------------------------------------------------------------
 
-	for( int i = 0; i < pattern.number.value; ++i ) {
-		if( particleIDs.empty() )
-			break;
+void addToEmitter( Emitter* emitter, ParticleRange range ) {
+	for( size_t i = range.first; i < range.last; ++i )
+		emitter->particles.push_back( store.handle( i ) );
+}
 
-		Particle particle = pattern.process( parent, i, pattern.number.value );
+//--------------------------------------------------------------------------------
 
-		particle.current = particle.initial;
-		particle.group = gId;
-		particle.alive = true;
+ParticleRange spawnParticle( const CompiledPattern& pattern,
+							 sf::Transformable parentTransform,
+							 std::span< const microseconds > ages ) {
+	return spawnBatch( pattern, false, Store::none, ParticleHandle(), ages, [&pattern]( int index, int total, const SpawnRolls& rolls ) {
+		return pattern.process( index, total, &rolls );
+	} );
+}
 
-		const size_t pId = particleIDs.top();
-		particleIDs.pop();
+//--------------------------------------------------------------------------------
 
-		particles.at( pId ) = particle;
-		out.push_back( &particles.at( pId ) );
-		particleCount++;
+ParticleRange spawnParticle( const CompiledPattern& pattern, ParticleHandle parentHandle, std::span< const microseconds > ages ) {
+	const size_t parent = store.resolve( parentHandle );
+	if( parent == Store::none )
+		return ParticleRange();
 
-		Affector::apply( &particle, sf::Time::Zero );
+	// Counts against the budget of the system the parent came from, if it's still around
+	Emitter* emitter   = getEmitter( store.emitter[ parent ] );
+	const size_t quota = emitter != nullptr ? emitter->budget : Store::none;
+
+	// Recycling moves particles, the parent is resolved again
+	const ParticleRange out = spawnBatch( pattern, true, quota, parentHandle, ages, [&pattern, parentHandle]( int index, int total, const SpawnRolls& rolls ) {
+		return pattern.process( store, store.resolve( parentHandle ), index, total, &rolls );
+	} );
+
+	if( emitter != nullptr ) {
+		emitter->budget -= std::min( emitter->budget, out.size() );
+		if( !pattern.analytic )
+			addToEmitter( emitter, out );
 	}
 
-	if( parent->parent != nullptr )
-		parent->emitter->particles.insert( parent->emitter->particles.end(), out.begin(), out.end() );
+	return out;
+}
 
-	groups.at( gId ).particles.insert( groups.at( gId ).particles.end(), out.begin(), out.end() );
+//--------------------------------------------------------------------------------
+
+ParticleRange spawnParticle( const CompiledPattern& pattern, Emitter* parent, std::span< const microseconds > ages ) {
+	const size_t quota		= parent != nullptr ? parent->budget : Store::none;
+	const ParticleRange out = spawnBatch( pattern, false, quota, ParticleHandle(), ages, [&pattern, parent]( int index, int total, const SpawnRolls& rolls ) {
+		Particle particle = pattern.process( index, total, &rolls );
+		particle.emitter  = parent != nullptr ? parent->handle : EmitterHandle();
+		return particle;
+	} );
+
+	if( parent != nullptr ) {
+		parent->budget -= std::min( parent->budget, out.size() );
+		if( !pattern.analytic )
+			addToEmitter( parent, out );
+	}
 
 	return out;
 }
 
 //--------------------------------------------------------------------------------
 
-list< Particle* > spawnParticle( ParticlePattern pattern, Emitter* parent ) {
-	list< Particle* > out;
+void queueSpawn( const CompiledPattern& pattern, ParticleHandle parent, microseconds age ) {
+	spawnQueues.at( Jobs::getThreadIndex() ).push_back( SpawnRequest{ &pattern, parent, age } );
+}
 
-	Math::processSet( pattern.number );
+//--------------------------------------------------------------------------------
 
-	RenderProperties properties;
-	properties.priority = pattern.priority;
-	properties.texture = Sprite::get( pattern.texture );
+void flushSpawns() {
+	// Spawning can queue more, those wait for the next flush
+	pendingSpawns.clear();
+	for( vector< SpawnRequest >& queue : spawnQueues ) {
+		pendingSpawns.insert( pendingSpawns.end(), queue.begin(), queue.end() );
+		queue.clear();
+	}
 
-	size_t gId = getGroupID( properties );
+	// By parent, the queue a request landed in depends on scheduling
+	std::stable_sort( pendingSpawns.begin(), pendingSpawns.end(), []( const SpawnRequest& a, const SpawnRequest& b ) {
+		return store.resolve( a.parent ) < store.resolve( b.parent );
+	} );
 
-	for( int i = 0; i < pattern.number.value; ++i ) {
-		Particle particle = pattern.process( i, pattern.number.value );
+	// Runs of the same pattern and parent spawn as one batch
+	size_t first = 0u;
+	while( first < pendingSpawns.size() ) {
+		const SpawnRequest& request = pendingSpawns[ first ];
 
-		if( parent != nullptr )
-			particle.emitter = parent;
-		particle.group = gId;
-		particle.alive = true;
+		pendingAges.clear();
+		size_t last = first;
+		while( last < pendingSpawns.size() && pendingSpawns[ last ].pattern == request.pattern
+			   && pendingSpawns[ last ].parent == request.parent )
+			pendingAges.push_back( pendingSpawns[ last++ ].age );
 
-		const size_t pId = particleIDs.top();
-		particleIDs.pop();
+		if( request.parent == ParticleHandle() )
+			spawnParticle( *request.pattern, sf::Transformable(), pendingAges );
+		else
+			spawnParticle( *request.pattern, request.parent, pendingAges );
 
-		particles.at( pId ) = particle;
-		out.push_back( &particles.at( pId ) );
-		particleCount++;
+		first = last;
+	}
+}
+
+//--------------------------------------------------------------------------------
 
-		Affector::apply( &particle, sf::Time::Zero );
+EmitterHandle addEmitter( Emitter* emitter ) {
+	if( freeEmitterSlots.empty() ) {
+		freeEmitterSlots.push_back( uint32_t( emitters.size() ) );
+		emitters.push_back( nullptr );
+		emitterGenerations.push_back( 0u );
 	}
 
-	if( parent != nullptr )
-		parent->particles.insert( parent->particles.begin(), out.begin(), out.end() );
+	const uint32_t slot = freeEmitterSlots.back();
+	freeEmitterSlots.pop_back();
 
-	groups.at( gId ).particles.insert( groups.at( gId ).particles.end(), out.begin(), out.end() );
+	emitters[ slot ] = emitter;
+	return EmitterHandle{ slot, emitterGenerations[ slot ] };
+}
 
-	return out;
+//--------------------------------------------------------------------------------
+
+void removeEmitter( EmitterHandle handle ) {
+	if( getEmitter( handle ) == nullptr )
+		return;
+
+	emitters[ handle.slot ] = nullptr;
+	emitterGenerations[ handle.slot ]++;
+	freeEmitterSlots.push_back( handle.slot );
+}
+
+//--------------------------------------------------------------------------------
+
+Emitter* getEmitter( EmitterHandle handle ) {
+	if( handle.slot >= emitters.size() || emitterGenerations[ handle.slot ] != handle.generation )
+		return nullptr;
+	return emitters[ handle.slot ];
+}
+
+//--------------------------------------------------------------------------------
+
+Store& getStore() {
+	return store;
+}
+
+//--------------------------------------------------------------------------------
+
+Store& getAnalyticStore() {
+	return analytic;
 }
 
 //--------------------------------------------------------------------------------
 
 size_t getParticleCount() {
-	return particleCount;
+	return store.size() + analytic.size();
 }
 
 //--------------------------------------------------------------------------------
@@ -446,6 +859,18 @@ size_t getRenderGroupCount() {
 
 //--------------------------------------------------------------------------------
 
+void setCatchingUp( bool catching ) {
+	catchingUp = catching;
+}
+
+//--------------------------------------------------------------------------------
+
+bool isVisible( const sf::FloatRect& area ) {
+	return !viewKnown || viewBounds.intersects( area );
+}
+
+//--------------------------------------------------------------------------------
+
 }
 
 //================================================================================
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 #include "global.h"
 
+#include <span>
+
 #include "particle.h"
 
 //================================================================================
@@ -18,19 +20,62 @@ namespace Manager {
 
 //--------------------------------------------------------------------------------
 
-void init();
+constexpr size_t defaultParticleLimit = 100000u;
+
+//--------------------------------------------------------------------------------
+
+// Limit is the per store particle budget, storage is only allocated as it fills
+void init( size_t particleLimit = defaultParticleLimit );
 void update( sf::Time delta );
 void postUpdate( sf::Time delta );
+// Culls against view and fills every group's vertices, render does this first.
+// Needs no render target.
+void buildVertices( const sf::View& view );
 void render( sf::RenderTarget* target );
 void clearAll();
+// Clears everything and frees the GPU buffers, before the GL context goes
+void shutdown();
+
+// Spawns the whole pattern in one batch. The returned range holds dense indices
+// and is only valid until the next update, take handles to keep them longer.
+// Patterns are compiled, see ParticlePattern::compile and Loader::get.
+// Analytic patterns spawn into getAnalyticStore() and aren't tracked by their
+// emitter, so emitter affectors and Emitter::kill don't reach them.
+// ages spawns the pattern once per entry in the same batch, each spawn stepped
+// ahead by its age, so emission between frames looks the same at any frame
+// rate. Empty is a single spawn right now.
+ParticleRange spawnParticle( const CompiledPattern& pattern,
+							 sf::Transformable parentTransform	  = sf::Transformable(),
+							 std::span< const microseconds > ages = {} );
+ParticleRange spawnParticle( const CompiledPattern& pattern, ParticleHandle parent, std::span< const microseconds > ages = {} );
+ParticleRange spawnParticle( const CompiledPattern& pattern, Emitter* parent, std::span< const microseconds > ages = {} );
 
-list< Particle* > spawnParticle( ParticlePattern pattern, sf::Transformable parentTransform = sf::Transformable() );
-list< Particle* > spawnParticle( ParticlePattern pattern, Particle* parent );
-list< Particle* > spawnParticle( ParticlePattern pattern, Emitter* parent );
+// Safe to call from jobs. Spawned at the next sync point in update, the
+// pattern must outlive that. Consecutive requests of the same pattern and
+// parent share a batch.
+void queueSpawn( const CompiledPattern& pattern, ParticleHandle parent = ParticleHandle(), microseconds age = 0us );
+
+// Emitters are referenced by handle, so particles outliving their System don't
+// reach a destroyed one. System registers its emitters and removes them when
+// it's destroyed, getEmitter is nullptr from then on.
+EmitterHandle addEmitter( Emitter* emitter );
+void removeEmitter( EmitterHandle handle );
+Emitter* getEmitter( EmitterHandle handle );
+
+Store& getStore();
+Store& getAnalyticStore();
 
 size_t getParticleCount();
 size_t getRenderGroupCount();
 
+// While set, spawns that expired before they came due are dropped. Otherwise
+// those of patterns with on death emitters are spawned dead so the emitters
+// still fire, see System::fastForward.
+void setCatchingUp( bool catching );
+
+// Whether area overlaps the view of the last buildVertices, true before the first
+bool isVisible( const sf::FloatRect& area );
+
 //--------------------------------------------------------------------------------
 
 }
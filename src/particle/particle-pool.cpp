@@ -0,0 +1,103 @@
+//================================================================================
+
+#include "particle-pool.h"
+
+//--------------------------------------------------------------------------------
+
+#include "app.h"
+#include "system.h"
+
+#include "particle-emitter.h"
+#include "particle-system.h"
+
+//================================================================================
+
+namespace Gfx::Particle::Pool {
+
+//--------------------------------------------------------------------------------
+
+struct Effect {
+	vector< EmitterPattern > emitters;
+	vector< shared_ptr< System > > instances;
+};
+
+map< string, Effect > effects;
+
+//================================================================================
+
+// Parented to the app so it gets updated, kept alive by the pool
+shared_ptr< System > build( const Effect& effect ) {
+	shared_ptr< System > out = Object::makeObject< System >( ::System::getApp().get() );
+	for( const EmitterPattern& emitter : effect.emitters )
+		out->addEmitter( emitter );
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+void add( const string& name, vector< EmitterPattern > emitters, size_t reserve ) {
+	Effect& effect = effects[ name ];
+	for( const shared_ptr< System >& instance : effect.instances )
+		instance->destroy();
+
+	effect.emitters = std::move( emitters );
+	effect.instances.clear();
+
+	for( size_t i = 0u; i < reserve; ++i )
+		effect.instances.push_back( build( effect ) );
+}
+
+//--------------------------------------------------------------------------------
+
+shared_ptr< System > fire( const string& name, sf::Transformable transform ) {
+	const auto it = effects.find( name );
+	if( it == effects.end() )
+		return nullptr;
+
+	Effect& effect = it->second;
+
+	// Destroyed with the app's children, those never update again
+	effect.instances.erase( std::remove_if( effect.instances.begin(),
+											effect.instances.end(),
+											[]( const shared_ptr< System >& instance ) { return instance->isMarkedForRemoval(); } ),
+							effect.instances.end() );
+
+	const auto idle = std::find_if( effect.instances.begin(),
+									effect.instances.end(),
+									[]( const shared_ptr< System >& instance ) { return instance->isIdle(); } );
+
+	shared_ptr< System > out;
+	if( idle != effect.instances.end() )
+		out = *idle;
+	else {
+		out = build( effect );
+		effect.instances.push_back( out );
+	}
+
+	out->setTransform( transform );
+	out->start();
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t getInstanceCount( const string& name ) {
+	const auto it = effects.find( name );
+	return it != effects.end() ? it->second.instances.size() : 0u;
+}
+
+//--------------------------------------------------------------------------------
+
+void clear() {
+	for( auto& [name, effect] : effects )
+		for( const shared_ptr< System >& instance : effect.instances )
+			instance->destroy();
+
+	effects.clear();
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Pool
+
+//================================================================================
@@ -0,0 +1,47 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+//================================================================================
+
+namespace Gfx::Particle {
+
+//--------------------------------------------------------------------------------
+
+class System;
+struct EmitterPattern;
+
+//--------------------------------------------------------------------------------
+
+// Reusable System instances for effects fired often, like hit sparks.
+// An instance is built once, emitters compiled and affectors made, and fired
+// again once it's idle instead of creating a new object every time.
+// Effects are named by the caller, a System is built from several emitter
+// patterns rather than one loaded pattern file.
+namespace Pool {
+
+//--------------------------------------------------------------------------------
+
+// Registers how the effect is built and builds reserve instances up front.
+// Replaces an earlier effect of the same name, destroying its instances.
+void add( const string& name, vector< EmitterPattern > emitters, size_t reserve = 0u );
+
+// Starts an idle instance of the effect at transform, building one when all
+// are busy. nullptr for an effect that was never added.
+shared_ptr< System > fire( const string& name, sf::Transformable transform );
+
+size_t getInstanceCount( const string& name );
+
+// Destroys every instance
+void clear();
+
+//--------------------------------------------------------------------------------
+
+}
+}
+
+//================================================================================
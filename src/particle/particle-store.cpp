@@ -0,0 +1,272 @@
+//================================================================================
+
+#include "particle-store.h"
+
+//--------------------------------------------------------------------------------
+
+#include <cmath>
+
+#include "particle.h"
+
+//================================================================================
+
+namespace Gfx::Particle {
+
+//--------------------------------------------------------------------------------
+
+void PropertyColumns::resize( size_t size ) {
+	positionX.resize( size );
+	positionY.resize( size );
+	velocityX.resize( size );
+	velocityY.resize( size );
+	accelerationX.resize( size );
+	accelerationY.resize( size );
+	rotation.resize( size );
+	spin.resize( size );
+	scaleX.resize( size );
+	scaleY.resize( size );
+
+	colorR.resize( size );
+	colorG.resize( size );
+	colorB.resize( size );
+	colorA.resize( size );
+
+	duration.resize( size );
+	remaining.resize( size );
+}
+
+//--------------------------------------------------------------------------------
+
+void PropertyColumns::set( size_t id, const ParticleProperties& properties ) {
+	setPosition( id, properties.position );
+	setVelocity( id, properties.velocity );
+	setAcceleration( id, properties.acceleration );
+	rotation[ id ] = properties.rotation;
+	spin[ id ]	   = properties.spin;
+	setScale( id, properties.scale );
+	setColor( id, properties.color );
+
+	duration[ id ]	= properties.duration;
+	remaining[ id ] = properties.remaining;
+}
+
+//--------------------------------------------------------------------------------
+
+void PropertyColumns::copy( const PropertyColumns& source, size_t begin, size_t end ) {
+	const auto copyColumn = [begin, end]( const auto& from, auto& to ) {
+		std::copy( from.begin() + begin, from.begin() + end, to.begin() + begin );
+	};
+
+	copyColumn( source.positionX, positionX );
+	copyColumn( source.positionY, positionY );
+	copyColumn( source.velocityX, velocityX );
+	copyColumn( source.velocityY, velocityY );
+	copyColumn( source.accelerationX, accelerationX );
+	copyColumn( source.accelerationY, accelerationY );
+	copyColumn( source.rotation, rotation );
+	copyColumn( source.spin, spin );
+	copyColumn( source.scaleX, scaleX );
+	copyColumn( source.scaleY, scaleY );
+
+	copyColumn( source.colorR, colorR );
+	copyColumn( source.colorG, colorG );
+	copyColumn( source.colorB, colorB );
+	copyColumn( source.colorA, colorA );
+
+	copyColumn( source.duration, duration );
+	copyColumn( source.remaining, remaining );
+}
+
+//--------------------------------------------------------------------------------
+
+void PropertyColumns::move( size_t from, size_t to ) {
+	positionX[ to ]		= positionX[ from ];
+	positionY[ to ]		= positionY[ from ];
+	velocityX[ to ]		= velocityX[ from ];
+	velocityY[ to ]		= velocityY[ from ];
+	accelerationX[ to ] = accelerationX[ from ];
+	accelerationY[ to ] = accelerationY[ from ];
+	rotation[ to ]		= rotation[ from ];
+	spin[ to ]			= spin[ from ];
+	scaleX[ to ]		= scaleX[ from ];
+	scaleY[ to ]		= scaleY[ from ];
+
+	colorR[ to ] = colorR[ from ];
+	colorG[ to ] = colorG[ from ];
+	colorB[ to ] = colorB[ from ];
+	colorA[ to ] = colorA[ from ];
+
+	duration[ to ]	= duration[ from ];
+	remaining[ to ] = remaining[ from ];
+}
+
+//--------------------------------------------------------------------------------
+
+float PropertyColumns::getRotation( size_t id ) const {
+	float out = fmodf( rotation[ id ], 360.f );
+	if( out < 0.f )
+		out += 360.f;
+	return out;
+}
+
+//================================================================================
+
+void Store::init( size_t limit ) {
+	clear();
+	this->limit = limit;
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::clear() {
+	for( size_t i = 0u; i < count; ++i ) {
+		alive[ i ] = false;
+		affectors[ i ].clear();
+		sharedAffectors[ i ].reset();
+		generations[ slots[ i ] ]++;
+	}
+
+	count = 0u;
+
+	freeSlots.clear();
+	for( size_t i = capacity(); i != 0; --i )
+		freeSlots.push_back( uint32_t( i - 1u ) );
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::reserve( size_t size ) {
+	size = std::min( size, limit );
+
+	const size_t from = capacity();
+	if( size <= from )
+		return;
+
+	// At least double, in whole pages, so growth stays amortised
+	size = std::max( size, from * 2u );
+	size = std::min( ( size + pageSize - 1u ) / pageSize * pageSize, limit );
+
+	current.resize( size );
+	frame.resize( size );
+	lifetime.resize( size );
+	spawned.resize( size );
+	importance.resize( size );
+	texCoords.resize( size );
+
+	affectors.resize( size );
+	sharedAffectors.resize( size );
+	group.resize( size );
+	parent.resize( size );
+	depth.resize( size );
+	attached.resize( size, false );
+	emitter.resize( size );
+
+	alive.resize( size, false );
+	dead.resize( size, false );
+
+	slots.resize( size );
+	indices.resize( size, 0u );
+	generations.resize( size, 0u );
+
+	freeSlots.reserve( size );
+	for( size_t i = size; i != from; --i )
+		freeSlots.push_back( uint32_t( i - 1u ) );
+}
+
+//--------------------------------------------------------------------------------
+
+ParticleRange Store::allocate( size_t size ) {
+	const ParticleRange out{ count, count + ( full() ? size_t( 0u ) : std::min( size, limit - count ) ) };
+	reserve( out.last );
+
+	for( size_t index = out.first; index < out.last; ++index ) {
+		const uint32_t slot = freeSlots.back();
+		freeSlots.pop_back();
+
+		slots[ index ]	= slot;
+		indices[ slot ] = uint32_t( index );
+	}
+
+	count = out.last;
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::set( size_t index, Particle&& particle, size_t groupID, sf::FloatRect region ) {
+	current.set( index, particle.initial );
+	frame.set( index, particle.initial );
+	lifetime[ index ]  = particle.initial.remaining;
+	texCoords[ index ] = region;
+
+	affectors[ index ]		 = std::move( particle.affectors );
+	sharedAffectors[ index ] = std::move( particle.sharedAffectors );
+	group[ index ]			 = groupID;
+	parent[ index ]			 = particle.parent;
+	attached[ index ]		 = particle.attached;
+	emitter[ index ]		 = particle.emitter;
+
+	const size_t parentIndex = resolve( particle.parent );
+	depth[ index ]			 = parentIndex == none ? 0u : depth[ parentIndex ] + 1u;
+
+	alive[ index ] = true;
+	dead[ index ]  = false;
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::compact() {
+	size_t i = 0u;
+	while( i < count ) {
+		if( alive[ i ] )
+			++i;
+		else
+			release( i );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::release( size_t index ) {
+	const uint32_t slot = slots[ index ];
+	generations[ slot ]++;
+	freeSlots.push_back( slot );
+
+	const size_t last = --count;
+	if( index != last )
+		move( last, index );
+
+	affectors[ last ].clear();
+	sharedAffectors[ last ].reset();
+}
+
+//--------------------------------------------------------------------------------
+
+void Store::move( size_t from, size_t to ) {
+	current.move( from, to );
+	frame.move( from, to );
+	lifetime[ to ]	 = lifetime[ from ];
+	spawned[ to ]	 = spawned[ from ];
+	importance[ to ] = importance[ from ];
+	texCoords[ to ]	 = texCoords[ from ];
+
+	affectors[ to ]		  = std::move( affectors[ from ] );
+	sharedAffectors[ to ] = std::move( sharedAffectors[ from ] );
+	group[ to ]			  = group[ from ];
+	parent[ to ]		  = parent[ from ];
+	depth[ to ]			  = depth[ from ];
+	attached[ to ]		  = attached[ from ];
+	emitter[ to ]		  = emitter[ from ];
+
+	alive[ to ] = alive[ from ];
+	dead[ to ]	= dead[ from ];
+
+	slots[ to ]				= slots[ from ];
+	indices[ slots[ to ] ]	= uint32_t( to );
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle
+
+//================================================================================
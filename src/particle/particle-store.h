@@ -0,0 +1,223 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "mathtypes.h"
+
+//================================================================================
+
+namespace Gfx::Particle {
+
+//--------------------------------------------------------------------------------
+
+struct Emitter;
+struct Particle;
+struct ParticleProperties;
+
+namespace Affector {
+class Affector;
+}
+
+//--------------------------------------------------------------------------------
+
+using AffectorList = vector< shared_ptr< Affector::Affector > >;
+
+//--------------------------------------------------------------------------------
+
+// Simulated particle state, one contiguous column per component.
+// Indexed by dense particle index, see Store.
+struct PropertyColumns {
+	vector< float > positionX;
+	vector< float > positionY;
+	vector< float > velocityX;
+	vector< float > velocityY;
+	vector< float > accelerationX;
+	vector< float > accelerationY;
+	vector< float > rotation;
+	vector< float > spin;
+	vector< float > scaleX;
+	vector< float > scaleY;
+
+	vector< float > colorR;
+	vector< float > colorG;
+	vector< float > colorB;
+	vector< float > colorA;
+
+	vector< microseconds > duration;
+	vector< microseconds > remaining;
+
+	void resize( size_t size );
+
+	void set( size_t id, const ParticleProperties& properties );
+	// Copies [begin, end) of every column
+	void copy( const PropertyColumns& source, size_t begin, size_t end );
+	void move( size_t from, size_t to );
+
+	Math::Vec2 getPosition( size_t id ) const { return Math::Vec2( positionX[ id ], positionY[ id ] ); }
+	void setPosition( size_t id, Math::Vec2 position ) {
+		positionX[ id ] = position.x;
+		positionY[ id ] = position.y;
+	}
+
+	Math::Vec2 getVelocity( size_t id ) const { return Math::Vec2( velocityX[ id ], velocityY[ id ] ); }
+	void setVelocity( size_t id, Math::Vec2 velocity ) {
+		velocityX[ id ] = velocity.x;
+		velocityY[ id ] = velocity.y;
+	}
+
+	Math::Vec2 getAcceleration( size_t id ) const {
+		return Math::Vec2( accelerationX[ id ], accelerationY[ id ] );
+	}
+	void setAcceleration( size_t id, Math::Vec2 acceleration ) {
+		accelerationX[ id ] = acceleration.x;
+		accelerationY[ id ] = acceleration.y;
+	}
+
+	Math::Vec2 getScale( size_t id ) const { return Math::Vec2( scaleX[ id ], scaleY[ id ] ); }
+	void setScale( size_t id, Math::Vec2 scale ) {
+		scaleX[ id ] = scale.x;
+		scaleY[ id ] = scale.y;
+	}
+
+	// Wrapped to [0, 360), matching sf::Transformable::getRotation
+	float getRotation( size_t id ) const;
+
+	Math::Color getColor( size_t id ) const {
+		return Math::Color( colorR[ id ], colorG[ id ], colorB[ id ], colorA[ id ] );
+	}
+	void setColor( size_t id, Math::Color color ) {
+		colorR[ id ] = color.r;
+		colorG[ id ] = color.g;
+		colorB[ id ] = color.b;
+		colorA[ id ] = color.a;
+	}
+};
+
+//--------------------------------------------------------------------------------
+
+// Stable reference to a particle.
+// The slot never moves while the particle lives, and the generation is bumped
+// when the slot is released so stale handles stop resolving.
+struct ParticleHandle {
+	uint32_t slot{ std::numeric_limits< uint32_t >::max() };
+	uint32_t generation{ 0u };
+
+	bool operator==( const ParticleHandle& rh ) const = default;
+};
+
+//--------------------------------------------------------------------------------
+
+// Stable reference to an Emitter, see Manager::addEmitter.
+// Stops resolving once the emitter is removed with its System.
+struct EmitterHandle {
+	uint32_t slot{ std::numeric_limits< uint32_t >::max() };
+	uint32_t generation{ 0u };
+
+	bool operator==( const EmitterHandle& rh ) const = default;
+};
+
+//--------------------------------------------------------------------------------
+
+// Dense index range [first, last), valid until the next compaction
+struct ParticleRange {
+	size_t first{ 0u };
+	size_t last{ 0u };
+
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+};
+
+//--------------------------------------------------------------------------------
+
+// Structure-of-arrays particle pool.
+// Live particles are packed in [0, size()), dead ones are swap-removed by
+// compact(). Dense indices are only stable between compactions, anything
+// that outlives a frame should hold a ParticleHandle instead.
+// Columns start empty and grow in pages as particles are allocated, up to limit.
+struct Store {
+	static constexpr size_t none	 = std::numeric_limits< size_t >::max();
+	static constexpr size_t pageSize = 4096u;
+
+	PropertyColumns current;
+	PropertyColumns frame;
+	vector< microseconds > lifetime;
+	// Manager clock at spawn, analytic particles derive their age from it
+	vector< microseconds > spawned;
+	// Budget level of the spawning pattern, see ParticlePattern::importance
+	vector< int > importance;
+	// Atlas region in pixels
+	vector< sf::FloatRect > texCoords;
+
+	// Instances with per-particle state, like emitters
+	vector< list< shared_ptr< Affector::Affector > > > affectors;
+	// Immutable instances shared by every particle of a spawn, run after the own ones
+	vector< shared_ptr< const AffectorList > > sharedAffectors;
+	vector< size_t > group;
+	vector< ParticleHandle > parent;
+	// Parents above it at spawn, roots are 0
+	vector< uint32_t > depth;
+	// Dies with its parent, from attached lifetime inheritance
+	vector< uint8_t > attached;
+	vector< EmitterHandle > emitter;
+
+	vector< uint8_t > alive;
+	vector< uint8_t > dead;
+
+	// Dense index -> slot
+	vector< uint32_t > slots;
+
+	// Slot -> dense index / generation
+	vector< uint32_t > indices;
+	vector< uint32_t > generations;
+	vector< uint32_t > freeSlots;
+
+	size_t count{ 0u };
+	// Particle budget, may change at runtime. Lowering it below size() only
+	// stops new allocations, grown columns are kept.
+	size_t limit{ 0u };
+
+	void init( size_t limit );
+	void clear();
+	// Grows every column to hold at least size particles, capped at limit
+	void reserve( size_t size );
+
+	// Grown size of the columns, not the budget
+	size_t capacity() const { return generations.size(); }
+	size_t size() const { return count; }
+	bool full() const { return count >= limit; }
+
+	// Appends up to count uninitialised particles to the dense range, fewer when
+	// the budget runs out. Every index in the result must be set() before the next update.
+	ParticleRange allocate( size_t count );
+	void set( size_t index, Particle&& particle, size_t groupID, sf::FloatRect region );
+
+	bool hasAffectors( size_t index ) const { return !affectors[ index ].empty() || sharedAffectors[ index ]; }
+
+	ParticleHandle handle( size_t index ) const {
+		return ParticleHandle{ slots[ index ], generations[ slots[ index ] ] };
+	}
+	size_t resolve( ParticleHandle handle ) const {
+		if( handle.slot >= capacity() || generations[ handle.slot ] != handle.generation )
+			return none;
+		return indices[ handle.slot ];
+	}
+	bool valid( ParticleHandle handle ) const { return resolve( handle ) != none; }
+
+	// Swap-removes every particle that is no longer alive.
+	void compact();
+	// Swap-removes one particle right away, the last one takes its index
+	void release( size_t index );
+
+private:
+	void move( size_t from, size_t to );
+};
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle
+
+//================================================================================
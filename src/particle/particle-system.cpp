@@ -19,15 +19,58 @@ namespace Gfx::Particle {
 
 //--------------------------------------------------------------------------------
 
-System::System() : Object() {
+// Streams are handed out in creation order
+uint64_t nextStream{ 0u };
+
+// Longest sleep a system catches up on, anything before that is lost
+constexpr microseconds maxSleep = 60s;
+// How far back fastForward emits for emitters whose particles never expire
+constexpr microseconds foreverHorizon = 5s;
+
+//================================================================================
+
+System::System() : Object(), m_random( Random::makeStream( nextStream++ ) ) {
 	//
 }
 
 //--------------------------------------------------------------------------------
 
+System::~System() {
+	clearEmitters();
+}
+
+//--------------------------------------------------------------------------------
+
 void System::onUpdate( sf::Time deltaTime ) {
-	for( Emitter& emitter : m_emitters )
+	if( m_sleepRadius > 0.f ) {
+		const sf::Vector2f position = m_transform.getPosition();
+		const sf::FloatRect area( position.x - m_sleepRadius,
+								  position.y - m_sleepRadius,
+								  m_sleepRadius * 2.f,
+								  m_sleepRadius * 2.f );
+
+		if( !Manager::isVisible( area ) ) {
+			m_asleep = true;
+			m_slept = std::min( m_slept + microseconds( deltaTime.asMicroseconds() ), maxSleep );
+			return;
+		}
+
+		if( m_asleep ) {
+			fastForward( m_slept );
+			m_asleep = false;
+			m_slept	 = 0us;
+		}
+	}
+
+	Random::ScopedStream random( m_random );
+
+	// Shared by the emitters in order, counted before they drop dead handles
+	size_t budget = getBudgetLeft();
+	for( Emitter& emitter : m_emitters ) {
+		emitter.budget = budget;
 		emitter.update( deltaTime );
+		budget = emitter.budget;
+	}
 
 	Affector::apply( this, deltaTime );
 }
@@ -41,6 +84,12 @@ void System::start() {
 
 //--------------------------------------------------------------------------------
 
+bool System::isActive() const {
+	return std::any_of( m_emitters.begin(), m_emitters.end(), []( const Emitter& emitter ) { return emitter.active; } );
+}
+
+//--------------------------------------------------------------------------------
+
 void System::stop() {
 	for( Emitter& emitter : m_emitters )
 		emitter.stop();
@@ -55,14 +104,97 @@ void System::kill() {
 
 //--------------------------------------------------------------------------------
 
+void System::fastForward( microseconds time ) {
+	Random::ScopedStream random( m_random );
+
+	Manager::setCatchingUp( true );
+
+	size_t budget = getBudgetLeft();
+	for( Emitter& emitter : m_emitters ) {
+		emitter.budget = budget;
+		const microseconds lifetime = emitter.getMaxLifetime();
+		emitter.step( time, lifetime > 0us ? lifetime : foreverHorizon );
+		budget = emitter.budget;
+	}
+
+	Manager::setCatchingUp( false );
+}
+
+//--------------------------------------------------------------------------------
+
+void System::prewarm( microseconds time ) {
+	start();
+	fastForward( time );
+}
+
+//--------------------------------------------------------------------------------
+
+void System::prewarm() {
+	microseconds time = 0us;
+	for( const Emitter& emitter : m_emitters )
+		time = std::max( time, emitter.initial.delay + emitter.getMaxLifetime() );
+
+	prewarm( time );
+}
+
+//--------------------------------------------------------------------------------
+
+size_t System::getParticleCount() const {
+	size_t out = 0u;
+	for( const Emitter& emitter : m_emitters )
+		out += emitter.particles.size();
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t System::getBudgetLeft() const {
+	if( m_budget == 0u )
+		return Store::none;
+	return m_budget - std::min( m_budget, getParticleCount() );
+}
+
+//--------------------------------------------------------------------------------
+
 void System::addEmitter( EmitterPattern emitter ) {
+	Random::ScopedStream random( m_random );
+
 	Emitter e = emitter.process();
-	e.initial.transform.move( m_transform.getPosition() );
-	e.initial.transform.scale( m_transform.getScale() );
-	e.initial.transform.rotate( m_transform.getRotation() );
+	e.offset  = e.initial.transform;
+	place( e );
 	e.current = e.initial;
 
 	m_emitters.push_back( e );
+	m_emitters.back().handle = Manager::addEmitter( &m_emitters.back() );
+}
+
+//--------------------------------------------------------------------------------
+
+void System::clearEmitters() {
+	for( const Emitter& emitter : m_emitters )
+		Manager::removeEmitter( emitter.handle );
+
+	m_emitters.clear();
+}
+
+//--------------------------------------------------------------------------------
+
+void System::setTransform( sf::Transformable transform ) {
+	m_transform = transform;
+
+	for( Emitter& emitter : m_emitters ) {
+		place( emitter );
+		emitter.current.transform = emitter.initial.transform;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void System::place( Emitter& emitter ) const {
+	emitter.initial.transform = emitter.offset;
+	emitter.initial.transform.move( m_transform.getPosition() );
+	emitter.initial.transform.scale( m_transform.getScale() );
+	emitter.initial.transform.rotate( m_transform.getRotation() );
 }
 
 //--------------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #include "global.h"
 #include "object.h"
 #include "particle-emitter.h"
+#include "random.h"
 
 //================================================================================
 
@@ -17,7 +18,12 @@ namespace Gfx::Particle {
 class System : public Object {
 public:
 	System();
-	virtual ~System() = default;
+	// Emitters are registered by address, a copy would share the original's
+	// handles. Moving keeps the list nodes, so makeObject can still move.
+	System( const System& ) = delete;
+	System( System&& ) = default;
+	System& operator=( const System& ) = delete;
+	virtual ~System();
 
 public:
 	void onUpdate( sf::Time deltaTime ) override;
@@ -27,19 +33,67 @@ public:
 	void stop();
 	void kill();
 
+	// Whether any emitter is still running
+	bool isActive() const;
+	// Done running with none of its particles left, see Pool
+	bool isIdle() const { return !isActive() && getParticleCount() == 0u; }
+
 	void addEmitter( EmitterPattern emitter );
+	// Removes every emitter, their particles stay until they expire
+	void clearEmitters();
 
 	const list< Emitter >& getEmitters() const { return m_emitters; }
 	list< Emitter >& getEmitters() { return m_emitters; }
 
+	// Everything the system spawns draws from its own stream, so an effect
+	// plays back the same for the same seed
+	void setSeed( uint64_t seed ) { m_random = Random::Stream( seed, 0u ); }
+
+	// Most particles the emitters keep alive at once, 0 for no limit.
+	// Applies on top of the Manager's Budget.
+	void setBudget( size_t budget ) { m_budget = budget; }
+	size_t getBudget() const { return m_budget; }
+	// Tracked particles of every emitter, analytic ones aren't
+	size_t getParticleCount() const;
+
+	// With a radius, the system stops emitting while that far outside the view
+	// and catches up in one batch when it's back, see fastForward. Particles
+	// already out keep being simulated until they expire. 0 never sleeps.
+	// Only the last minute of a sleep is caught up on.
+	void setSleepRadius( float radius ) { m_sleepRadius = radius; }
+	float getSleepRadius() const { return m_sleepRadius; }
+	bool isAsleep() const { return m_asleep; }
+
+	// Emits everything due over time at once, each spawn stepped to where it
+	// would be now. Spawns that would have expired by now are skipped, for
+	// particles that never expire those older than a few seconds.
+	void fastForward( microseconds time );
+
+	// Starts as if it had been running for time already. Without a time, for
+	// the longest lifetime the emitters can spawn, which is the steady state.
+	// Particles that never expire have none, those only skip the delay.
+	void prewarm( microseconds time );
+	void prewarm();
+
 	sf::Transformable getTransform() const { return m_transform; }
-	void setTransform( sf::Transformable transform ) {
-		m_transform = transform;
-	}
+	// Moves the emitters along, relative to where their patterns put them
+	void setTransform( sf::Transformable transform );
+
+private:
+	// Particles the emitters may still spawn, Store::none without a budget
+	size_t getBudgetLeft() const;
+	// Emitter transform from its pattern's and the system's
+	void place( Emitter& emitter ) const;
 
 private:
 	list< Emitter > m_emitters;
 	sf::Transformable m_transform;
+	Random::Stream m_random;
+	size_t m_budget{ 0u };
+
+	float m_sleepRadius{ 0.f };
+	bool m_asleep{ false };
+	microseconds m_slept{ 0 };
 };
 
 //--------------------------------------------------------------------------------
@@ -0,0 +1,110 @@
+//================================================================================
+
+#include "particle-vertices.h"
+
+//--------------------------------------------------------------------------------
+
+#include <cmath>
+
+//================================================================================
+
+namespace Gfx::Particle::Vertices {
+
+//--------------------------------------------------------------------------------
+
+size_t buildQuads( const Store& store, const size_t* indices, size_t count, sf::Vertex* out ) {
+	constexpr float toRadians = PI / 180.f;
+
+	const PropertyColumns& frame = store.frame;
+
+	for( size_t i = 0u; i < count; ++i ) {
+		const size_t id = indices[ i ];
+
+		const sf::FloatRect& region = store.texCoords[ id ];
+		const float left			= region.left;
+		const float top				= region.top;
+		const float right			= region.left + region.width;
+		const float bottom			= region.top + region.height;
+
+		const float angle = frame.rotation[ id ] * toRadians;
+		const float cosine = std::cos( angle );
+		const float sine   = std::sin( angle );
+
+		const float halfX = frame.scaleX[ id ] * .5f;
+		const float halfY = frame.scaleY[ id ] * .5f;
+
+		// Rotated half extents along the local x and y axes
+		const float ax = cosine * halfX;
+		const float ay = sine * halfX;
+		const float bx = -sine * halfY;
+		const float by = cosine * halfY;
+
+		const float px = frame.positionX[ id ];
+		const float py = frame.positionY[ id ];
+
+		const sf::Color color(
+			sf::Uint8( frame.colorR[ id ] * 255.f ),
+			sf::Uint8( frame.colorG[ id ] * 255.f ),
+			sf::Uint8( frame.colorB[ id ] * 255.f ),
+			sf::Uint8( frame.colorA[ id ] * 255.f ) );
+
+		sf::Vertex* quad = out + i * perQuad;
+
+		quad[ 0 ] = sf::Vertex( sf::Vector2f( px - ax - bx, py - ay - by ), color, sf::Vector2f( left, top ) );
+		quad[ 1 ] = sf::Vertex( sf::Vector2f( px + ax - bx, py + ay - by ), color, sf::Vector2f( right, top ) );
+		quad[ 2 ] = sf::Vertex( sf::Vector2f( px + ax + bx, py + ay + by ), color, sf::Vector2f( right, bottom ) );
+		quad[ 3 ] = sf::Vertex( sf::Vector2f( px - ax + bx, py - ay + by ), color, sf::Vector2f( left, bottom ) );
+	}
+
+	return count * perQuad;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t buildOutlines( const sf::Vertex* quads, size_t quadCount, sf::Color color, sf::Vertex* out ) {
+	for( size_t i = 0u; i < quadCount; ++i ) {
+		const sf::Vertex* quad = quads + i * perQuad;
+		sf::Vertex* lines	   = out + i * perOutline;
+
+		for( size_t corner = 0u; corner < perQuad; ++corner ) {
+			lines[ corner * 2u ]	  = sf::Vertex( quad[ corner ].position, color );
+			lines[ corner * 2u + 1u ] = sf::Vertex( quad[ ( corner + 1u ) % perQuad ].position, color );
+		}
+	}
+
+	return quadCount * perOutline;
+}
+
+//--------------------------------------------------------------------------------
+
+sf::FloatRect getBounds( const sf::View& view ) {
+	// Inverse of the view transform maps clip space back to the world
+	return view.getInverseTransform().transformRect( sf::FloatRect( -1.f, -1.f, 2.f, 2.f ) );
+}
+
+//--------------------------------------------------------------------------------
+
+void cull( const Store& store, size_t begin, size_t end, const sf::FloatRect& bounds, uint8_t* out ) {
+	const PropertyColumns& frame = store.frame;
+
+	const float left   = bounds.left;
+	const float top	   = bounds.top;
+	const float right  = bounds.left + bounds.width;
+	const float bottom = bounds.top + bounds.height;
+
+	for( size_t id = begin; id < end; ++id ) {
+		// Covers the half diagonal whatever the rotation
+		const float radius = ( std::abs( frame.scaleX[ id ] ) + std::abs( frame.scaleY[ id ] ) ) * .5f;
+
+		const float px = frame.positionX[ id ];
+		const float py = frame.positionY[ id ];
+
+		out[ id ] = px + radius >= left && px - radius <= right && py + radius >= top && py - radius <= bottom;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Vertices
+
+//================================================================================
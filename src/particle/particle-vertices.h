@@ -0,0 +1,42 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include "particle-store.h"
+
+//================================================================================
+
+// Quad generation straight from the store columns.
+// Kept apart from the draw so it can run without a render target.
+namespace Gfx::Particle::Vertices {
+
+//--------------------------------------------------------------------------------
+
+constexpr size_t perQuad	= 4u;
+constexpr size_t perOutline = 8u;
+
+//--------------------------------------------------------------------------------
+
+// Writes 4 vertices per particle to out, same corners as sf::Transformable with
+// the origin at the quad center. Returns the number of vertices written.
+size_t buildQuads( const Store& store, const size_t* indices, size_t count, sf::Vertex* out );
+
+// Writes 8 line vertices per quad in quads, tracing its edges.
+size_t buildOutlines( const sf::Vertex* quads, size_t quadCount, sf::Color color, sf::Vertex* out );
+
+// World space bounds of what the view shows, rotation included
+sf::FloatRect getBounds( const sf::View& view );
+
+// Sets out[ i ] for every dense index in [begin, end) whose quad may overlap bounds.
+// Conservative, a quad is tested by a circle around its half extents.
+void cull( const Store& store, size_t begin, size_t end, const sf::FloatRect& bounds, uint8_t* out );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Gfx::Particle::Vertices
+
+//================================================================================
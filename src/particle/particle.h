@@ -5,12 +5,15 @@
 //================================================================================
 
 #include "app.h"
+#include "atlas.h"
+#include "binary.h"
 #include "global.h"
 #include "imgui-utils.h"
 #include "json.h"
 #include "particle-affector-manager.h"
 #include "particle-affector.h"
 #include "particle-loader.h"
+#include "particle-store.h"
 #include "random.h"
 #include "sprite.h"
 #include "string-utils.h"
@@ -21,12 +24,15 @@
 namespace Gfx::Particle {
 
 struct Emitter;
+struct CompiledPattern;
 class System;
 
 //--------------------------------------------------------------------------------
 
 struct ParticleProperties {
-	sf::Transformable transform{};
+	Math::Vec2 position{ Math::Vec2() };
+	float rotation{ 0.f };
+	Math::Vec2 scale{ Math::Vec2( 1.f, 1.f ) };
 
 	Math::Vec2 velocity{ Math::Vec2() };
 	Math::Vec2 acceleration{ Math::Vec2() };
@@ -36,34 +42,47 @@ struct ParticleProperties {
 
 	microseconds duration{ 0ms };
 	microseconds remaining{ 0ms };
+
+	// Steps the state age ahead in one go, with constant acceleration and spin.
+	// Only finite lifetimes count down, like in Manager::update.
+	void advance( microseconds age ) {
+		const float t = float( age.count() ) / 1000000.f;
+
+		position += velocity * t + acceleration * ( t * t * .5f );
+		velocity += acceleration * t;
+		rotation += spin * t;
+
+		duration += age;
+		if( remaining > 0ms )
+			remaining -= age;
+	}
 };
 
 //--------------------------------------------------------------------------------
 
+// Spawn-time description of a particle, written into the Store by the Manager.
 struct Particle {
 	ParticleProperties initial;
-	ParticleProperties current;
-	ParticleProperties frame;
 
 	list< shared_ptr< Affector::Affector > > affectors;
-	size_t group{ std::numeric_limits< size_t >::max() };
+	shared_ptr< const AffectorList > sharedAffectors;
 
-	Particle* parent;
-	Emitter* emitter;
-
-	bool dead{ false };
-	bool alive{ false };
-	bool fresh{ true };
+	ParticleHandle parent{};
+	// Dies with its parent, see Inheritance::Value::attach
+	bool attached{ false };
+	EmitterHandle emitter{};
 };
 
 //--------------------------------------------------------------------------------
 
+// Particle textures live in atlas pages, so groups only split on these
 struct RenderProperties {
-	Sprite::ID texture{ 0u };
+	size_t page{ 0u };
 	int priority{ 0 };
+	sf::BlendMode blend{ sf::BlendAdd };
 
 	bool operator==( const RenderProperties& rh ) {
-		return rh.priority == priority && rh.texture == texture;
+		return rh.priority == priority && rh.page == page && rh.blend == blend;
 	}
 };
 
@@ -96,6 +115,15 @@ struct Inheritance {
 				json::getValue( value["attach"], attach );
 		}
 
+		void setValue( json::Stream& in ) {
+			in.readObject( [this, &in]( std::string_view key ) {
+				if( key == "type" )
+					json::getValue( in, ( int& ) type );
+				else if( key == "attach" )
+					json::getValue( in, attach );
+			} );
+		}
+
 		bool render( string name ) {
 			bool out = false;
 
@@ -206,6 +234,33 @@ struct Inheritance {
 			json::getValue( value["rotateVelocity"], rotateVelocity );
 	}
 
+	void setValue( json::Stream& in ) {
+		in.readObject( [this, &in]( std::string_view key ) {
+			if( key == "lifetime" )
+				lifetime.setValue( in );
+			else if( key == "position" )
+				position.setValue( in );
+			else if( key == "rotation" )
+				rotation.setValue( in );
+			else if( key == "spin" )
+				spin.setValue( in );
+			else if( key == "scale" )
+				scale.setValue( in );
+			else if( key == "color" )
+				color.setValue( in );
+			else if( key == "alpha" )
+				alpha.setValue( in );
+			else if( key == "velocity" )
+				velocity.setValue( in );
+			else if( key == "acceleration" )
+				acceleration.setValue( in );
+			else if( key == "scaleVelocity" )
+				json::getValue( in, scaleVelocity );
+			else if( key == "rotateVelocity" )
+				json::getValue( in, rotateVelocity );
+		} );
+	}
+
 	bool render() {
 		bool out = false;
 		ImGui::PushID( "Inheritance" );
@@ -248,22 +303,6 @@ struct ParticleEmitter {
 
 	bool onDeath{ false };
 
-	shared_ptr< Affector::Affector > process() {
-		vector< ParticlePattern* > vPatterns;
-		for( string pattern : patterns )
-			vPatterns.push_back( Loader::get( pattern ) );
-
-		if( onDeath )
-			return make_shared< Affector::OnDeathEmitterAffector >( type, vPatterns );
-		else {
-			Math::processSet( duration );
-			Math::processSet( delay );
-
-			return make_shared< Affector::EmitterAffector >(
-				type, milliseconds( delay.value ), milliseconds( duration.value ), rate, vPatterns );
-		}
-	}
-
 	rapidjson::Value getValue() {
 		rapidjson::Value out;
 		out.SetObject();
@@ -308,6 +347,48 @@ struct ParticleEmitter {
 		}
 	}
 
+	void setValue( json::Stream& in ) {
+		in.readObject( [this, &in]( std::string_view key ) {
+			if( key == "type" )
+				json::getValue( in, ( int& ) type );
+			else if( key == "duration" )
+				json::getValue( in, duration );
+			else if( key == "delay" )
+				json::getValue( in, delay );
+			else if( key == "rate" )
+				json::getValue( in, rate );
+			else if( key == "onDeath" )
+				json::getValue( in, onDeath );
+			else if( key == "patterns" ) {
+				in.readArray( [this, &in] {
+					string s;
+					json::getValue( in, s );
+					patterns.push_back( s );
+				} );
+			}
+		} );
+	}
+
+	void write( Binary::Writer& out ) const {
+		out.write( type, duration, delay, rate, onDeath, uint32_t( patterns.size() ) );
+		for( const string& pattern : patterns )
+			out.write( pattern );
+	}
+
+	bool read( Binary::Reader& in ) {
+		uint32_t count = 0u;
+		in.read( type, duration, delay, rate, onDeath, count );
+
+		patterns.clear();
+		for( uint32_t i = 0u; i < count && in.ok(); ++i ) {
+			string pattern;
+			if( in.read( pattern ) )
+				patterns.push_back( pattern );
+		}
+
+		return in.ok();
+	}
+
 	bool render() {
 		bool out = false;
 
@@ -413,9 +494,29 @@ struct ParticleEmitter {
 
 //--------------------------------------------------------------------------------
 
-struct ParticlePattern {
-	string name = "New Pattern";
+// Random draws for a whole burst, made in bulk before its particles are built
+struct SpawnRolls {
+	vector< int > lifetime;
+	vector< float > rotation;
+	vector< float > spin;
+};
 
+//--------------------------------------------------------------------------------
+
+// Emitter attached to every particle of a pattern, with its patterns resolved
+struct CompiledEmitter {
+	EmitterType type;
+	Math::ValueSet< int > duration{ 0 };
+	Math::ValueSet< int > delay{ 0 };
+	Math::ValueSet< float > rate{ 0.f };
+	vector< const CompiledPattern* > patterns;
+};
+
+//--------------------------------------------------------------------------------
+
+// Spawn-ready form of a ParticlePattern, built by ParticlePattern::compile()
+// and only read from after that. Value sets are rolled into locals per spawn.
+struct CompiledPattern {
 	Math::ValueSet< int > lifetime{ 0 };
 	Math::ValueSet< int > number{ 0 };
 	Math::ValueSet< Math::Color > color{ Colors::WHITE };
@@ -423,61 +524,107 @@ struct ParticlePattern {
 	Math::ValueSet< Math::Vec2 > scale{ Math::Vec2() };
 	Math::ValueSet< float > spin{ 0.f };
 
-	string texture{ "./Data/Assets/Particles/default.png" };
-	int priority{ 0 };
-
 	Math::Position position{};
 	Math::Velocity velocity{};
 	Math::Velocity acceleration{};
 
 	Inheritance inheritance;
 
-	list< shared_ptr< Affector::AffectorCreator > > affectors;
-	vector< ParticleEmitter > emitters;
+	// Atlas region in pixels, and the render group it goes in
+	sf::FloatRect texCoords;
+	RenderProperties properties;
+
+	// Spawns into the Manager's analytic store, see ParticlePattern::analytic
+	bool analytic{ false };
+	// See ParticlePattern::importance
+	int importance{ 0 };
+
+	// Batched ones add table rows per spawn, the rest make an instance per particle
+	vector< shared_ptr< Affector::AffectorCreator > > batched;
+	vector< shared_ptr< Affector::AffectorCreator > > instanced;
+	vector< CompiledEmitter > emitters;
+
+	// Affectors without per-particle state, shared by every particle spawned.
+	// Child spawns also get the attached inheritance ones.
+	shared_ptr< const AffectorList > shared;
+	shared_ptr< const AffectorList > sharedChild;
+
+	int rollNumber() const { return Math::rollSet( number ); }
+
+	// Longest lifetime a spawn can roll, 0 when some never expire
+	microseconds getMaxLifetime() const {
+		const int shortest = lifetime.random ? std::min( lifetime.min, lifetime.max ) : lifetime.min;
+		const int longest  = lifetime.random ? std::max( lifetime.min, lifetime.max ) : lifetime.min;
+		if( shortest <= 0 || lifetime.inverse )
+			return 0ms;
+		return milliseconds( longest );
+	}
+
+	void roll( SpawnRolls& out, int total ) const {
+		out.lifetime.resize( size_t( total ) );
+		out.rotation.resize( size_t( total ) );
+		out.spin.resize( size_t( total ) );
 
-	Particle process( int index = 0, int total = 0 ) {
-		Math::processSet( lifetime );
-		Math::processSet( color );
-		Math::processSet( scale );
-		Math::processSet( rotation );
-		Math::processSet( spin );
+		Math::processSet( lifetime, out.lifetime );
+		Math::processSet( rotation, out.rotation );
+		Math::processSet( spin, out.spin );
+	}
 
+	Particle process( int index = 0, int total = 0, const SpawnRolls* rolls = nullptr ) const {
 		ParticleProperties properties;
-		properties.color	 = color.value;
-		properties.remaining = milliseconds( lifetime.value );
+		if( rolls != nullptr ) {
+			properties.remaining = milliseconds( rolls->lifetime[ index ] );
+			properties.rotation	 = rolls->rotation[ index ];
+			properties.spin		 = rolls->spin[ index ];
+		}
+		else {
+			properties.remaining = milliseconds( Math::rollSet( lifetime ) );
+			properties.rotation	 = Math::rollSet( rotation );
+			properties.spin		 = Math::rollSet( spin );
+		}
+		properties.color = Math::rollSet( color );
+		properties.scale = Math::rollSet( scale );
 
-		Math::Vec2 pos = position.process( index, total );
-		properties.transform.setOrigin( sf::Vector2f( .5f, .5f ) );
-		properties.transform.setPosition( pos.sf() );
-		properties.transform.setScale( scale.value.sf() );
-		properties.transform.setRotation( rotation.value );
-		properties.spin = spin.value;
+		Math::Position p = position;
+		Math::Velocity v = velocity;
+		Math::Velocity a = acceleration;
 
-		properties.velocity		= velocity.process( pos );
-		properties.acceleration = acceleration.process( pos );
+		properties.position		= p.process( index, total );
+		properties.velocity		= v.process( properties.position );
+		properties.acceleration = a.process( properties.position );
 
 		Particle out;
 		out.initial = properties;
-		out.current = properties;
-		out.frame	= properties;
 
-		for( shared_ptr< Affector::AffectorCreator > affector : affectors )
+		for( const shared_ptr< Affector::AffectorCreator >& affector : instanced )
 			out.affectors.push_back( affector->get() );
 
-		for( ParticleEmitter& emitter : emitters )
-			out.affectors.push_back( emitter.process() );
+		for( const CompiledEmitter& emitter : emitters ) {
+			const int duration = Math::rollSet( emitter.duration );
+			const int delay	   = Math::rollSet( emitter.delay );
+
+			out.affectors.push_back( make_shared< Affector::EmitterAffector >(
+				emitter.type, milliseconds( delay ), milliseconds( duration ), emitter.rate, emitter.patterns ) );
+		}
 
 		return out;
 	}
 
-	Particle process( Particle* parent, int index = 0, int total = 0 ) {
-		if( parent == nullptr )
-			return process( index, total );
+	Particle process( const Store& store,
+					  size_t parent,
+					  int index				  = 0,
+					  int total				  = 0,
+					  const SpawnRolls* rolls = nullptr ) const {
+		if( parent == Store::none )
+			return process( index, total, rolls );
+
+		Particle out = process( index, total, rolls );
+		out.parent	 = store.handle( parent );
+		out.emitter	 = store.emitter[ parent ];
+		out.attached = inheritance.lifetime.attach && inheritance.lifetime.type != InheritanceType::None;
 
-		Particle out = process( index, total );
-		out.parent	 = parent;
-		if( parent->emitter != nullptr )
-			out.emitter = parent->emitter;
+		const PropertyColumns& source = store.frame;
+		ParticleProperties& initial	  = out.initial;
 
 		// Inheritance
 
@@ -486,15 +633,14 @@ struct ParticlePattern {
 			switch( inheritance.lifetime.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.remaining = parent->initial.remaining;
+					initial.remaining = store.lifetime[ parent ];
 					break;
 				case InheritanceType::Offset:
-					out.initial.remaining += parent->initial.remaining;
+					initial.remaining += store.lifetime[ parent ];
 					break;
 				case InheritanceType::Multiply:
-					out.initial.remaining
-						= microseconds( out.initial.remaining.count()
-										* parent->initial.remaining.count() );
+					initial.remaining = microseconds( initial.remaining.count()
+													  * store.lifetime[ parent ].count() );
 					break;
 			}
 		}
@@ -504,15 +650,13 @@ struct ParticlePattern {
 			switch( inheritance.position.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.transform.setPosition( parent->frame.transform.getPosition() );
+					initial.position = source.getPosition( parent );
 					break;
 				case InheritanceType::Offset:
-					out.initial.transform.move( parent->frame.transform.getPosition() );
+					initial.position += source.getPosition( parent );
 					break;
 				case InheritanceType::Multiply:
-					Math::Vec2 pos = out.initial.transform.getPosition();
-					pos *= parent->frame.transform.getPosition();
-					out.initial.transform.setPosition( pos.sf() );
+					initial.position *= source.getPosition( parent );
 					break;
 			}
 		}
@@ -522,15 +666,13 @@ struct ParticlePattern {
 			switch( inheritance.rotation.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.transform.setRotation( parent->frame.transform.getRotation() );
+					initial.rotation = source.getRotation( parent );
 					break;
 				case InheritanceType::Offset:
-					out.initial.transform.rotate( parent->frame.transform.getRotation() );
+					initial.rotation += source.getRotation( parent );
 					break;
 				case InheritanceType::Multiply:
-					float rot = out.initial.transform.getRotation();
-					rot *= parent->frame.transform.getRotation();
-					out.initial.transform.setRotation( rot );
+					initial.rotation *= source.getRotation( parent );
 			}
 		}
 
@@ -539,13 +681,13 @@ struct ParticlePattern {
 			switch( inheritance.spin.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.spin = parent->frame.spin;
+					initial.spin = source.spin[ parent ];
 					break;
 				case InheritanceType::Offset:
-					out.initial.spin += parent->frame.spin;
+					initial.spin += source.spin[ parent ];
 					break;
 				case InheritanceType::Multiply:
-					out.initial.spin *= parent->frame.spin;
+					initial.spin *= source.spin[ parent ];
 					break;
 			}
 		}
@@ -555,15 +697,11 @@ struct ParticlePattern {
 			switch( inheritance.scale.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.transform.setScale( parent->frame.transform.getScale() );
+					initial.scale = source.getScale( parent );
 					break;
 				case InheritanceType::Offset:
-					out.initial.transform.scale( parent->frame.transform.getScale() );
-					break;
 				case InheritanceType::Multiply:
-					Math::Vec2 s = out.initial.transform.getScale();
-					s *= parent->frame.transform.getScale();
-					out.initial.transform.setScale( s.sf() );
+					initial.scale *= source.getScale( parent );
 					break;
 			}
 		}
@@ -573,19 +711,19 @@ struct ParticlePattern {
 			switch( inheritance.color.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.color.r = parent->frame.color.r;
-					out.initial.color.g = parent->frame.color.g;
-					out.initial.color.b = parent->frame.color.b;
+					initial.color.r = source.colorR[ parent ];
+					initial.color.g = source.colorG[ parent ];
+					initial.color.b = source.colorB[ parent ];
 					break;
 				case InheritanceType::Offset:
-					out.initial.color.r += parent->frame.color.r;
-					out.initial.color.g += parent->frame.color.g;
-					out.initial.color.b += parent->frame.color.b;
+					initial.color.r += source.colorR[ parent ];
+					initial.color.g += source.colorG[ parent ];
+					initial.color.b += source.colorB[ parent ];
 					break;
 				case InheritanceType::Multiply:
-					out.initial.color.r *= parent->frame.color.r;
-					out.initial.color.g *= parent->frame.color.g;
-					out.initial.color.b *= parent->frame.color.b;
+					initial.color.r *= source.colorR[ parent ];
+					initial.color.g *= source.colorG[ parent ];
+					initial.color.b *= source.colorB[ parent ];
 					break;
 			}
 		}
@@ -595,13 +733,13 @@ struct ParticlePattern {
 			switch( inheritance.alpha.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.color.a = parent->frame.color.a;
+					initial.color.a = source.colorA[ parent ];
 					break;
 				case InheritanceType::Offset:
-					out.initial.color.a += parent->frame.color.a;
+					initial.color.a += source.colorA[ parent ];
 					break;
 				case InheritanceType::Multiply:
-					out.initial.color.a *= parent->frame.color.a;
+					initial.color.a *= source.colorA[ parent ];
 					break;
 			}
 		}
@@ -611,25 +749,22 @@ struct ParticlePattern {
 			switch( inheritance.velocity.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.velocity = parent->frame.velocity;
+					initial.velocity = source.getVelocity( parent );
 					break;
 				case InheritanceType::Offset:
-					out.initial.velocity += parent->frame.velocity;
+					initial.velocity += source.getVelocity( parent );
 					break;
 				case InheritanceType::Multiply:
-					out.initial.velocity *= parent->frame.velocity;
+					initial.velocity *= source.getVelocity( parent );
 					break;
 			}
 
-			if( inheritance.scaleVelocity ) {
-				sf::Transform t;
-				t.scale( parent->frame.transform.getScale() );
-				out.initial.velocity = t.transformPoint( out.initial.velocity.sf() );
-			}
+			if( inheritance.scaleVelocity )
+				initial.velocity *= source.getScale( parent );
 			if( inheritance.rotateVelocity ) {
 				sf::Transform t;
-				t.rotate( parent->frame.transform.getRotation() );
-				out.initial.velocity = t.transformPoint( out.initial.velocity.sf() );
+				t.rotate( source.getRotation( parent ) );
+				initial.velocity = t.transformPoint( initial.velocity.sf() );
 			}
 		}
 
@@ -638,50 +773,140 @@ struct ParticlePattern {
 			switch( inheritance.acceleration.type ) {
 				case InheritanceType::None: break;
 				case InheritanceType::Copy:
-					out.initial.acceleration = parent->frame.acceleration;
+					initial.acceleration = source.getAcceleration( parent );
 					break;
 				case InheritanceType::Offset:
-					out.initial.acceleration += parent->frame.acceleration;
+					initial.acceleration += source.getAcceleration( parent );
 					break;
 				case InheritanceType::Multiply:
-					out.initial.acceleration *= parent->frame.acceleration;
+					initial.acceleration *= source.getAcceleration( parent );
 					break;
 			}
 		}
 
-		if( inheritance.lifetime.attach )
-			out.affectors.push_back( make_shared< Affector::InheritLifetimeAffector >(
-				inheritance.lifetime.type ) );
+		return out;
+	}
+};
+
+//--------------------------------------------------------------------------------
+
+struct ParticlePattern {
+	string name = "New Pattern";
+
+	Math::ValueSet< int > lifetime{ 0 };
+	Math::ValueSet< int > number{ 0 };
+	Math::ValueSet< Math::Color > color{ Colors::WHITE };
+	Math::ValueSet< float > rotation{ 0.f };
+	Math::ValueSet< Math::Vec2 > scale{ Math::Vec2() };
+	Math::ValueSet< float > spin{ 0.f };
+
+	string texture{ "./Data/Assets/Particles/default.png" };
+	int priority{ 0 };
+	// Budget level, picks the Budget::Quota that decides how spawns degrade
+	// near the particle limit. Unrelated to draw priority.
+	int importance{ 0 };
+
+	// Never simulated, evaluated from age when rendering instead.
+	// Only applies when isAnalytic() holds, the pattern is stepped as usual otherwise.
+	bool analytic{ false };
+
+	Math::Position position{};
+	Math::Velocity velocity{};
+	Math::Velocity acceleration{};
+
+	Inheritance inheritance;
+
+	list< shared_ptr< Affector::AffectorCreator > > affectors;
+	vector< ParticleEmitter > emitters;
+
+	// Whether the state of every particle is a closed-form function of spawn
+	// state and age: no emitters, no attached inheritance and only affectors
+	// that support it
+	bool isAnalytic() const {
+		if( !emitters.empty() )
+			return false;
+
+		for( const shared_ptr< Affector::AffectorCreator >& affector : affectors )
+			if( affector == nullptr || !affector->isAnalytic() )
+				return false;
+
+		const Inheritance& i = inheritance;
+		return !( i.lifetime.attach || i.position.attach || i.rotation.attach || i.spin.attach || i.scale.attach
+				  || i.color.attach || i.alpha.attach || i.velocity.attach || i.acceleration.attach );
+	}
+
+	// Resolves everything that doesn't change between spawns
+	CompiledPattern compile() const {
+		CompiledPattern out;
+		out.lifetime = lifetime;
+		out.number	 = number;
+		out.color	 = color;
+		out.rotation = rotation;
+		out.scale	 = scale;
+		out.spin	 = spin;
+
+		out.position	 = position;
+		out.velocity	 = velocity;
+		out.acceleration = acceleration;
+
+		out.inheritance = inheritance;
+
+		const Atlas::Region region = Atlas::get( Sprite::get( texture ) );
+		out.texCoords			   = region.texCoords;
+		out.properties.page		   = region.page;
+		out.properties.priority	   = priority;
+
+		out.importance = importance;
+		out.analytic   = analytic && isAnalytic();
+		if( analytic && !out.analytic )
+			Debug::addMessage( Utils::format( "%s can't be analytic, simulating it instead", name.c_str() ),
+							   DebugType::Warning );
+
+		for( const shared_ptr< Affector::AffectorCreator >& affector : affectors ) {
+			if( affector->isBatched() )
+				out.batched.push_back( affector );
+			else
+				out.instanced.push_back( affector );
+		}
+
+		// On death emitters have no state, they go in the shared list
+		AffectorList shared;
+		for( const ParticleEmitter& emitter : emitters ) {
+			vector< const CompiledPattern* > patterns;
+			for( const string& pattern : emitter.patterns )
+				patterns.push_back( Loader::get( pattern ) );
+
+			if( emitter.onDeath )
+				shared.push_back( make_shared< Affector::OnDeathEmitterAffector >( emitter.type, patterns ) );
+			else
+				out.emitters.push_back(
+					CompiledEmitter{ emitter.type, emitter.duration, emitter.delay, emitter.rate, patterns } );
+		}
+
+		if( !shared.empty() )
+			out.shared = make_shared< const AffectorList >( shared );
+
 		if( inheritance.position.attach )
-			out.affectors.push_back( make_shared< Affector::InheritPositionAffector >(
-				inheritance.position.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritPositionAffector >( inheritance.position.type ) );
 		if( inheritance.rotation.attach )
-			out.affectors.push_back( make_shared< Affector::InheritRotationAffector >(
-				inheritance.rotation.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritRotationAffector >( inheritance.rotation.type ) );
 		if( inheritance.spin.attach )
-			out.affectors.push_back(
-				make_shared< Affector::InheritSpinAffector >( inheritance.spin.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritSpinAffector >( inheritance.spin.type ) );
 		if( inheritance.scale.attach )
-			out.affectors.push_back( make_shared< Affector::InheritScaleAffector >(
-				inheritance.scale.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritScaleAffector >( inheritance.scale.type ) );
 		if( inheritance.color.attach )
-			out.affectors.push_back( make_shared< Affector::InheritColorAffector >(
-				inheritance.color.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritColorAffector >( inheritance.color.type ) );
 		if( inheritance.alpha.attach )
-			out.affectors.push_back( make_shared< Affector::InheritAlphaAffector >(
-				inheritance.alpha.type ) );
+			shared.push_back( Affector::getShared< Affector::InheritAlphaAffector >( inheritance.alpha.type ) );
 		if( inheritance.velocity.attach )
-			out.affectors.push_back( make_shared< Affector::InheritVelocityAffector >(
-				inheritance.velocity.type,
-				inheritance.scaleVelocity,
-				inheritance.rotateVelocity ) );
+			shared.push_back( Affector::getShared< Affector::InheritVelocityAffector >(
+				inheritance.velocity.type, inheritance.scaleVelocity, inheritance.rotateVelocity ) );
 		if( inheritance.acceleration.attach )
-			out.affectors.push_back( make_shared< Affector::InheritAccelerationAffector >(
-				inheritance.acceleration.type ) );
-
+			shared.push_back(
+				Affector::getShared< Affector::InheritAccelerationAffector >( inheritance.acceleration.type ) );
 
-		out.current = out.initial;
-		out.frame	= out.initial;
+		if( !shared.empty() )
+			out.sharedChild = make_shared< const AffectorList >( std::move( shared ) );
 
 		return out;
 	}
@@ -703,6 +928,8 @@ struct ParticlePattern {
 		out.AddMember( "inheritance", inheritance.getValue(), json::getAllocator() );
 		out.AddMember( "texture", json::getValue( texture ), json::getAllocator() );
 		out.AddMember( "priority", json::getValue( priority ), json::getAllocator() );
+		out.AddMember( "analytic", json::getValue( analytic ), json::getAllocator() );
+		out.AddMember( "importance", json::getValue( importance ), json::getAllocator() );
 
 		rapidjson::Value vAffectors;
 		vAffectors.SetArray();
@@ -749,6 +976,10 @@ struct ParticlePattern {
 			json::getValue( v["texture"], texture );
 		if( v.HasMember( "priority" ) )
 			json::getValue( v["priority"], priority );
+		if( v.HasMember( "analytic" ) )
+			json::getValue( v["analytic"], analytic );
+		if( v.HasMember( "importance" ) )
+			json::getValue( v["importance"], importance );
 		if( v.HasMember( "affectors" ) )
 			for( const rapidjson::Value& value : v["affectors"].GetArray() )
 				affectors.push_back( Affector::setValue( value ) );
@@ -763,6 +994,90 @@ struct ParticlePattern {
 		return true;
 	}
 
+	// Same as above, straight from the token stream
+	bool setValue( json::Stream& in ) {
+		return in.readObject( [this, &in]( std::string_view key ) {
+			if( key == "name" )
+				json::getValue( in, name );
+			else if( key == "lifetime" )
+				json::getValue( in, lifetime );
+			else if( key == "number" )
+				json::getValue( in, number );
+			else if( key == "color" )
+				json::getValue( in, color );
+			else if( key == "rotation" )
+				json::getValue( in, rotation );
+			else if( key == "scale" )
+				json::getValue( in, scale );
+			else if( key == "position" )
+				position.setValue( in );
+			else if( key == "velocity" )
+				velocity.setValue( in );
+			else if( key == "acceleration" )
+				acceleration.setValue( in );
+			else if( key == "spin" )
+				json::getValue( in, spin );
+			else if( key == "inheritance" )
+				inheritance.setValue( in );
+			else if( key == "texture" )
+				json::getValue( in, texture );
+			else if( key == "priority" )
+				json::getValue( in, priority );
+			else if( key == "analytic" )
+				json::getValue( in, analytic );
+			else if( key == "importance" )
+				json::getValue( in, importance );
+			else if( key == "affectors" )
+				in.readArray( [this, &in] { affectors.push_back( Affector::setValue( in ) ); } );
+			else if( key == "emitters" ) {
+				in.readArray( [this, &in] {
+					ParticleEmitter emitter;
+					emitter.setValue( in );
+					emitters.push_back( emitter );
+				} );
+			}
+		} );
+	}
+
+	// Same content as getValue, see Loader for the file format
+	void write( Binary::Writer& out ) const {
+		out.write( name, lifetime, number, color, rotation, scale, spin, texture, priority, analytic, importance );
+		out.write( position, velocity, acceleration, inheritance );
+
+		out.write( uint32_t( affectors.size() ) );
+		for( const shared_ptr< Affector::AffectorCreator >& affector : affectors )
+			Affector::write( out, affector );
+
+		out.write( uint32_t( emitters.size() ) );
+		for( const ParticleEmitter& emitter : emitters )
+			emitter.write( out );
+	}
+
+	bool read( Binary::Reader& in ) {
+		in.read( name, lifetime, number, color, rotation, scale, spin, texture, priority, analytic, importance );
+		in.read( position, velocity, acceleration, inheritance );
+
+		uint32_t count = 0u;
+		in.read( count );
+		affectors.clear();
+		for( uint32_t i = 0u; i < count && in.ok(); ++i ) {
+			shared_ptr< Affector::AffectorCreator > affector = Affector::read( in );
+			if( affector == nullptr )
+				return false;
+			affectors.push_back( affector );
+		}
+
+		in.read( count );
+		emitters.clear();
+		for( uint32_t i = 0u; i < count && in.ok(); ++i ) {
+			ParticleEmitter emitter;
+			if( emitter.read( in ) )
+				emitters.push_back( emitter );
+		}
+
+		return in.ok();
+	}
+
 	bool render() {
 		bool out = false;
 
@@ -796,6 +1111,18 @@ struct ParticlePattern {
 			ImGui::Separator();
 			ImGui::Separator();
 
+			ImGui::Text( "Importance" );
+			ImGui::Separator();
+			out |= ImGui::InputInt( "##Importance", &importance );
+			ImGui::Separator();
+			ImGui::Separator();
+
+			out |= ImGui::Checkbox( "Analytic", &analytic );
+			if( analytic && !isAnalytic() )
+				ImGui::Text( "Simulated anyway, has emitters, attached\ninheritance or affectors that need stepping" );
+			ImGui::Separator();
+			ImGui::Separator();
+
 			ImGui::Text( "Rotation" );
 			ImGui::Separator();
 			out |= ImGui::render( rotation, "##Rotation" );
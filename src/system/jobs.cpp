@@ -0,0 +1,171 @@
+//================================================================================
+
+#include "jobs.h"
+
+//--------------------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//================================================================================
+
+namespace Jobs {
+
+//--------------------------------------------------------------------------------
+
+struct Batch {
+	const function< void( size_t, size_t ) >* func{ nullptr };
+	size_t count{ 0u };
+	size_t chunkSize{ 0u };
+	size_t chunks{ 0u };
+
+	std::atomic< size_t > next{ 0u };
+	std::atomic< size_t > done{ 0u };
+
+	// Workers holding a pointer to this batch, guarded by mutex
+	size_t users{ 0u };
+};
+
+//--------------------------------------------------------------------------------
+
+vector< std::thread > workers;
+
+std::mutex mutex;
+std::condition_variable wake;
+std::condition_variable finished;
+
+Batch* batch{ nullptr };
+uint64_t generation{ 0u };
+bool stopping{ false };
+
+thread_local size_t threadIndex{ 0u };
+
+//--------------------------------------------------------------------------------
+
+// Pulls chunks until the batch is drained
+void work( Batch& current ) {
+	size_t chunk;
+	while( ( chunk = current.next.fetch_add( 1u ) ) < current.chunks ) {
+		const size_t begin = chunk * current.chunkSize;
+		const size_t end   = std::min( begin + current.chunkSize, current.count );
+
+		( *current.func )( begin, end );
+
+		if( current.done.fetch_add( 1u ) + 1u == current.chunks ) {
+			std::lock_guard< std::mutex > lock( mutex );
+			finished.notify_all();
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void workerLoop( size_t index ) {
+	threadIndex = index;
+
+	uint64_t seen = 0u;
+	while( true ) {
+		Batch* current;
+		{
+			std::unique_lock< std::mutex > lock( mutex );
+			wake.wait( lock, [&seen] { return stopping || ( generation != seen && batch != nullptr ); } );
+			if( stopping )
+				return;
+
+			seen	= generation;
+			current = batch;
+			current->users++;
+		}
+
+		work( *current );
+
+		std::lock_guard< std::mutex > lock( mutex );
+		current->users--;
+		finished.notify_all();
+	}
+}
+
+//================================================================================
+
+void init( size_t count ) {
+	if( !workers.empty() )
+		return;
+
+	if( count == 0u ) {
+		const size_t hardware = std::thread::hardware_concurrency();
+		count				  = hardware > 1u ? hardware - 1u : 0u;
+	}
+
+	stopping = false;
+	for( size_t i = 0u; i < count; ++i )
+		workers.emplace_back( workerLoop, i + 1u );
+}
+
+//--------------------------------------------------------------------------------
+
+void shutdown() {
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for( std::thread& worker : workers )
+		worker.join();
+	workers.clear();
+}
+
+//--------------------------------------------------------------------------------
+
+size_t getThreadCount() {
+	return workers.size() + 1u;
+}
+
+//--------------------------------------------------------------------------------
+
+size_t getThreadIndex() {
+	return threadIndex;
+}
+
+//--------------------------------------------------------------------------------
+
+void parallelFor( size_t count, size_t chunkSize, const function< void( size_t begin, size_t end ) >& func ) {
+	if( count == 0u )
+		return;
+
+	chunkSize = std::max< size_t >( chunkSize, 1u );
+
+	// Not worth waking anyone
+	if( workers.empty() || count <= chunkSize ) {
+		func( 0u, count );
+		return;
+	}
+
+	Batch current;
+	current.func	  = &func;
+	current.count	  = count;
+	current.chunkSize = chunkSize;
+	current.chunks	  = ( count + chunkSize - 1u ) / chunkSize;
+
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		batch = &current;
+		generation++;
+	}
+	wake.notify_all();
+
+	work( current );
+
+	// The batch lives on this stack, wait until no worker can still reach it
+	std::unique_lock< std::mutex > lock( mutex );
+	finished.wait( lock, [&current] { return current.done.load() == current.chunks && current.users == 0u; } );
+	batch = nullptr;
+}
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Jobs
+
+//================================================================================
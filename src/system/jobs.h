@@ -0,0 +1,37 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+//================================================================================
+
+// Worker pool for data-parallel loops.
+// The calling thread works alongside the pool and returns once every chunk ran.
+namespace Jobs {
+
+//--------------------------------------------------------------------------------
+
+// 0 picks one worker per hardware thread, minus the main thread
+void init( size_t workers = 0u );
+void shutdown();
+
+// Workers plus the main thread
+size_t getThreadCount();
+
+// 0 on the main thread, 1..getThreadCount()-1 on workers.
+// Stable for the lifetime of the pool, usable as an index into per-thread data.
+size_t getThreadIndex();
+
+// Splits [0, count) into chunks of at most chunkSize and runs func( begin, end )
+// on each, in no particular order. Blocks until all chunks are done.
+// Must not be called from inside a job.
+void parallelFor( size_t count, size_t chunkSize, const function< void( size_t begin, size_t end ) >& func );
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Jobs
+
+//================================================================================
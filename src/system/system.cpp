@@ -8,6 +8,7 @@
 #include "app.h"
 #include "debug.h"
 #include "input.h"
+#include "jobs.h"
 #include "particle-affector.h"
 #include "particle-manager.h"
 #include "random.h"
@@ -62,6 +63,9 @@ bool init( shared_ptr< App > _app ) {
 	// Init debug handler
 	Debug::init( app.get() );
 
+	// Init job workers, before anything sizes per-thread data
+	Jobs::init();
+
 	// Init particles
 	Gfx::Particle::Manager::init();
 	Gfx::Particle::Affector::init();
@@ -83,6 +87,9 @@ int start() {
 	while( window.isOpen() )
 		update();
 
+	Gfx::Particle::Manager::shutdown();
+	Jobs::shutdown();
+
 	return 0;
 }
 
@@ -0,0 +1,143 @@
+//================================================================================
+
+#include "binary.h"
+
+//--------------------------------------------------------------------------------
+
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//================================================================================
+
+namespace Binary {
+
+//--------------------------------------------------------------------------------
+
+bool Writer::save( const string& path ) const {
+	const std::filesystem::path folder = std::filesystem::path( path ).parent_path();
+
+	std::error_code error;
+	if( !folder.empty() )
+		std::filesystem::create_directories( folder, error );
+
+	std::ofstream file( path, std::ios::binary | std::ios::trunc );
+	if( !file )
+		return false;
+
+	file.write( m_data.data(), std::streamsize( m_data.size() ) );
+	return bool( file );
+}
+
+//================================================================================
+
+Reader::Reader( std::span< const char > data, Header expected ) : m_data( data ) {
+	Header header;
+	get( header );
+	if( header != expected )
+		m_failed = true;
+}
+
+//================================================================================
+
+#ifdef _WIN32
+
+bool MappedFile::open( const string& path ) {
+	close();
+
+	m_file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+						  FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( m_file == INVALID_HANDLE_VALUE ) {
+		m_file = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( m_file, &size ) || size.QuadPart == 0 ) {
+		close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA( m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( m_mapping == nullptr ) {
+		close();
+		return false;
+	}
+
+	m_data = static_cast< const char* >( MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ) );
+	if( m_data == nullptr ) {
+		close();
+		return false;
+	}
+
+	m_size = size_t( size.QuadPart );
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+void MappedFile::close() {
+	if( m_data != nullptr )
+		UnmapViewOfFile( m_data );
+	if( m_mapping != nullptr )
+		CloseHandle( m_mapping );
+	if( m_file != nullptr )
+		CloseHandle( m_file );
+
+	m_data	  = nullptr;
+	m_size	  = 0u;
+	m_mapping = nullptr;
+	m_file	  = nullptr;
+}
+
+#else
+
+bool MappedFile::open( const string& path ) {
+	close();
+
+	const int file = ::open( path.c_str(), O_RDONLY );
+	if( file < 0 )
+		return false;
+
+	struct stat info;
+	if( fstat( file, &info ) != 0 || info.st_size == 0 ) {
+		::close( file );
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void* data = mmap( nullptr, size_t( info.st_size ), PROT_READ, MAP_PRIVATE, file, 0 );
+	::close( file );
+
+	if( data == MAP_FAILED )
+		return false;
+
+	m_data = static_cast< const char* >( data );
+	m_size = size_t( info.st_size );
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+void MappedFile::close() {
+	if( m_data != nullptr )
+		munmap( const_cast< char* >( m_data ), m_size );
+
+	m_data = nullptr;
+	m_size = 0u;
+}
+
+#endif
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Binary
+
+//================================================================================
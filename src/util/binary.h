@@ -0,0 +1,144 @@
+//================================================================================
+
+#pragma once
+
+//================================================================================
+
+#include "global.h"
+
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+//================================================================================
+
+// Flat binary files for assets that are loaded often.
+// Plain values are stored in native layout, so a file is only valid for builds
+// with the same Header::layout and is meant to be regenerated, not shipped.
+namespace Binary {
+
+//--------------------------------------------------------------------------------
+
+struct Header {
+	array< char, 4 > magic{};
+	uint32_t version{ 0u };
+	// Sizes of the raw structs the format relies on, mixed together
+	uint32_t layout{ 0u };
+
+	bool operator==( const Header& rh ) const = default;
+};
+
+//--------------------------------------------------------------------------------
+
+class Writer {
+public:
+	Writer( Header header ) { put( header ); }
+
+public:
+	template< class... T >
+	void write( const T&... values ) {
+		( put( values ), ... );
+	}
+
+	const vector< char >& getData() const { return m_data; }
+
+	// Creates missing folders
+	bool save( const string& path ) const;
+
+private:
+	template< class T >
+	void put( const T& value ) {
+		static_assert( std::is_trivially_copyable_v< T > );
+		const char* bytes = reinterpret_cast< const char* >( &value );
+		m_data.insert( m_data.end(), bytes, bytes + sizeof( T ) );
+	}
+
+	void put( const string& value ) {
+		put( uint32_t( value.size() ) );
+		m_data.insert( m_data.end(), value.begin(), value.end() );
+	}
+
+private:
+	vector< char > m_data;
+};
+
+//--------------------------------------------------------------------------------
+
+// Reads in place from data, which must outlive the reader.
+// Reading past the end or a header mismatch fails every later read.
+class Reader {
+public:
+	Reader( std::span< const char > data, Header expected );
+
+public:
+	template< class... T >
+	bool read( T&... values ) {
+		( get( values ), ... );
+		return !m_failed;
+	}
+
+	bool ok() const { return !m_failed; }
+
+private:
+	template< class T >
+	void get( T& value ) {
+		static_assert( std::is_trivially_copyable_v< T > );
+		if( !take( sizeof( T ) ) )
+			return;
+		std::memcpy( &value, m_data.data() + m_offset - sizeof( T ), sizeof( T ) );
+	}
+
+	void get( string& value ) {
+		uint32_t size = 0u;
+		get( size );
+		if( !take( size ) )
+			return;
+		value.assign( m_data.data() + m_offset - size, size );
+	}
+
+	bool take( size_t size ) {
+		if( m_failed || m_data.size() - m_offset < size ) {
+			m_failed = true;
+			return false;
+		}
+		m_offset += size;
+		return true;
+	}
+
+private:
+	std::span< const char > m_data;
+	size_t m_offset{ 0u };
+	bool m_failed{ false };
+};
+
+//--------------------------------------------------------------------------------
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile() { close(); }
+
+	MappedFile( const MappedFile& )			   = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+public:
+	bool open( const string& path );
+	void close();
+
+	std::span< const char > getData() const { return std::span< const char >( m_data, m_size ); }
+
+private:
+	const char* m_data{ nullptr };
+	size_t m_size{ 0u };
+#ifdef _WIN32
+	void* m_file{ nullptr };
+	void* m_mapping{ nullptr };
+#endif
+};
+
+//--------------------------------------------------------------------------------
+
+}	 // namespace Binary
+
+//================================================================================
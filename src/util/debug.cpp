@@ -503,14 +503,18 @@ void DebugHandler::addPerformancePage( string name, function< string() > func )
 
 //--------------------------------------------------------------------------------
 
+// Both are no-ops before init, headless runs have no debug UI
+
 void incDrawCall() {
-	handler->incDrawCall();
+	if( handler != nullptr )
+		handler->incDrawCall();
 }
 
 //--------------------------------------------------------------------------------
 
 void addPerformancePage( string name, function< string() > func ) {
-	handler->addPerformancePage( name, func );
+	if( handler != nullptr )
+		handler->addPerformancePage( name, func );
 }
 //================================================================================
 
@@ -8,6 +8,7 @@
 #include "string-utils.h"
 
 #include <filesystem>
+#include <fstream>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/filewritestream.h>
 #include <rapidjson/prettywriter.h>
@@ -77,7 +78,7 @@ bool load( function< bool( const rapidjson::Value& ) > func, string path ) {
 	if( pFile == nullptr )
 		return false;
 
-	char* buffer = new char[65536];
+	char buffer[65536];
 	FileReadStream is( pFile, buffer, sizeof( buffer ) );
 	Document document;
 	document.ParseStream< 0, UTF8<>, FileReadStream >( is );
@@ -91,13 +92,231 @@ bool load( function< bool( const rapidjson::Value& ) > func, string path ) {
 		return false;
 	}
 
-	delete[] buffer;
-
 	return func( document );
 }
 
 //--------------------------------------------------------------------------------
 
+bool load( function< bool( Stream& ) > func, string path ) {
+	Stream stream;
+	if( !stream.open( path ) )
+		return false;
+
+	const bool out = func( stream );
+
+	if( !stream.ok() ) {
+		Debug::addMessage( "Document \"" + path + "\" has JSON parse error", DebugType::Error );
+		return false;
+	}
+
+	return out;
+}
+
+//================================================================================
+
+// Stores each parser event as the stream's current token
+struct Stream::Handler {
+	Stream& stream;
+
+	bool set( Token token ) {
+		stream.m_token = token;
+		return true;
+	}
+	bool setInteger( int64_t value ) {
+		stream.m_integer = true;
+		stream.m_int	 = value;
+		stream.m_number	 = double( value );
+		return set( Token::Number );
+	}
+
+	bool Null() { return set( Token::Null ); }
+	bool Bool( bool value ) {
+		stream.m_bool = value;
+		return set( Token::Bool );
+	}
+	bool Int( int value ) { return setInteger( value ); }
+	bool Uint( unsigned value ) { return setInteger( value ); }
+	bool Int64( int64_t value ) { return setInteger( value ); }
+	bool Uint64( uint64_t value ) {
+		if( value > uint64_t( std::numeric_limits< int64_t >::max() ) )
+			return Double( double( value ) );
+		return setInteger( int64_t( value ) );
+	}
+	bool Double( double value ) {
+		stream.m_integer = false;
+		stream.m_number	 = value;
+		return set( Token::Number );
+	}
+	bool RawNumber( const char* value, rapidjson::SizeType length, bool copy ) { return false; }
+	bool String( const char* value, rapidjson::SizeType length, bool copy ) {
+		stream.m_string.assign( value, length );
+		return set( Token::String );
+	}
+	bool Key( const char* value, rapidjson::SizeType length, bool copy ) {
+		stream.m_string.assign( value, length );
+		return set( Token::Key );
+	}
+	bool StartObject() { return set( Token::StartObject ); }
+	bool EndObject( rapidjson::SizeType count ) { return set( Token::EndObject ); }
+	bool StartArray() { return set( Token::StartArray ); }
+	bool EndArray( rapidjson::SizeType count ) { return set( Token::EndArray ); }
+};
+
+//--------------------------------------------------------------------------------
+
+bool Stream::open( const string& path ) {
+	std::ifstream file( path, std::ios::binary | std::ios::ate );
+	if( !file )
+		return false;
+
+	const std::streamsize size = file.tellg();
+	file.seekg( 0 );
+
+	m_buffer.resize( size_t( size ) + 1u );
+	if( !file.read( m_buffer.data(), size ) )
+		return false;
+	m_buffer.back() = '\0';
+
+	m_input = rapidjson::StringStream( m_buffer.data() );
+	m_reader.IterativeParseInit();
+
+	m_token	   = Token::None;
+	m_position = 0u;
+	return true;
+}
+
+//--------------------------------------------------------------------------------
+
+Stream::Token Stream::peek() {
+	if( m_token != Token::None )
+		return m_token;
+
+	// Running out of tokens before the caller is done is an error too
+	Handler handler{ *this };
+	if( m_reader.IterativeParseComplete()
+		|| !m_reader.IterativeParseNext< rapidjson::kParseDefaultFlags >( m_input, handler ) || m_token == Token::None )
+		m_token = Token::Error;
+
+	return m_token;
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::next() {
+	if( peek() == Token::Error )
+		return;
+
+	m_token = Token::None;
+	m_position++;
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::skip() {
+	int depth = 0;
+	do {
+		const Token token = peek();
+		if( token == Token::Error )
+			return;
+
+		if( token == Token::StartObject || token == Token::StartArray )
+			depth++;
+		else if( token == Token::EndObject || token == Token::EndArray )
+			depth--;
+
+		next();
+	} while( depth > 0 );
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::read( bool& out ) {
+	if( peek() == Token::Bool )
+		out = m_bool;
+	skip();
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::read( float& out ) {
+	if( peek() == Token::Number )
+		out = float( m_number );
+	skip();
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::read( int& out ) {
+	if( peek() == Token::Number && m_integer && m_int >= std::numeric_limits< int >::min()
+		&& m_int <= std::numeric_limits< int >::max() )
+		out = int( m_int );
+	skip();
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::read( size_t& out ) {
+	if( peek() == Token::Number && m_integer && m_int >= 0 )
+		out = size_t( m_int );
+	skip();
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::read( string& out ) {
+	if( peek() == Token::String )
+		out = m_string;
+	skip();
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::readValue( rapidjson::Value& out ) {
+	switch( peek() ) {
+		case Token::Null:
+			out.SetNull();
+			next();
+			break;
+		case Token::Bool:
+			out.SetBool( m_bool );
+			next();
+			break;
+		case Token::Number:
+			if( !m_integer )
+				out.SetDouble( m_number );
+			else if( m_int >= std::numeric_limits< int >::min() && m_int <= std::numeric_limits< int >::max() )
+				out.SetInt( int( m_int ) );
+			else
+				out.SetInt64( m_int );
+			next();
+			break;
+		case Token::String:
+			out.SetString( m_string.data(), rapidjson::SizeType( m_string.size() ), m_arena );
+			next();
+			break;
+		case Token::StartObject:
+			out.SetObject();
+			readObject( [this, &out]( std::string_view key ) {
+				rapidjson::Value name( key.data(), rapidjson::SizeType( key.size() ), m_arena );
+				rapidjson::Value value;
+				readValue( value );
+				out.AddMember( name, value, m_arena );
+			} );
+			break;
+		case Token::StartArray:
+			out.SetArray();
+			readArray( [this, &out] {
+				rapidjson::Value value;
+				readValue( value );
+				out.PushBack( value, m_arena );
+			} );
+			break;
+		default: skip(); break;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 void setAllocator( rapidjson::MemoryPoolAllocator< rapidjson::CrtAllocator >* _allocator ) {
 	allocator = _allocator;
 }
@@ -391,6 +610,106 @@ void getValue( const rapidjson::Value& value, Math::Color& out ) {
 		getValue( value["a"], out.a );
 }
 
+//================================================================================
+
+template< class T >
+void getSet( Stream& value, Math::ValueSet< T >& out ) {
+	value.readObject( [&value, &out]( std::string_view key ) {
+		if( key == "min" )
+			getValue( value, out.min );
+		else if( key == "max" )
+			getValue( value, out.max );
+		else if( key == "random" )
+			getValue( value, out.random );
+		else if( key == "lock" )
+			getValue( value, out.lock );
+		else if( key == "inverse" )
+			getValue( value, out.inverse );
+		else if( key == "hsv" )
+			getValue( value, out.hsv );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::ValueSet< int >& out ) {
+	getSet( value, out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::ValueSet< float >& out ) {
+	getSet( value, out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::ValueSet< Math::Vec2 >& out ) {
+	getSet( value, out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::ValueSet< Math::Color >& out ) {
+	getSet( value, out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, bool& out ) {
+	value.read( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, float& out ) {
+	value.read( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, int& out ) {
+	value.read( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, size_t& out ) {
+	value.read( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, string& out ) {
+	value.read( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::Vec2& out ) {
+	value.readObject( [&value, &out]( std::string_view key ) {
+		if( key == "x" )
+			getValue( value, out.x );
+		else if( key == "y" )
+			getValue( value, out.y );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
+void getValue( Stream& value, Math::Color& out ) {
+	value.readObject( [&value, &out]( std::string_view key ) {
+		if( key == "r" )
+			getValue( value, out.r );
+		else if( key == "g" )
+			getValue( value, out.g );
+		else if( key == "b" )
+			getValue( value, out.b );
+		else if( key == "a" )
+			getValue( value, out.a );
+	} );
+}
+
 //--------------------------------------------------------------------------------
 
 }	 // namespace json
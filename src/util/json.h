@@ -8,6 +8,8 @@
 #include "mathtypes.h"
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <string_view>
 
 //================================================================================
 
@@ -15,8 +17,128 @@ namespace json {
 
 //--------------------------------------------------------------------------------
 
+class Stream;
+
 bool save( function< rapidjson::Value() > func, string path );
 bool load( function< bool( const rapidjson::Value& ) > func, string path );
+// Streams the file without building a DOM, see Stream
+bool load( function< bool( Stream& ) > func, string path );
+
+//--------------------------------------------------------------------------------
+
+// Pull parser that reads values straight into fields, for loading without a DOM.
+// The file buffer and anything copied out with readValue live in a per-load
+// arena, released with the stream.
+class Stream {
+public:
+	enum class Token {
+		None,
+		Null,
+		Bool,
+		Number,
+		String,
+		Key,
+		StartObject,
+		EndObject,
+		StartArray,
+		EndArray,
+		Error,
+	};
+
+public:
+	Stream() = default;
+
+	Stream( const Stream& )			   = delete;
+	Stream& operator=( const Stream& ) = delete;
+
+public:
+	bool open( const string& path );
+	bool ok() const { return m_token != Token::Error; }
+
+	Token peek();
+	void next();
+	// Consumes the value at the cursor, however deep
+	void skip();
+
+	// Calls func( key ) per member with the cursor on its value.
+	// Values func doesn't consume are skipped.
+	template< class Func >
+	bool readObject( Func func ) {
+		if( peek() != Token::StartObject ) {
+			skip();
+			return false;
+		}
+		next();
+
+		while( peek() == Token::Key ) {
+			const string key = m_string;
+			next();
+
+			const size_t position = m_position;
+			func( std::string_view( key ) );
+			if( m_position == position )
+				skip();
+		}
+
+		if( peek() != Token::EndObject )
+			return false;
+		next();
+		return true;
+	}
+
+	// Calls func() per element with the cursor on it, same rules as readObject
+	template< class Func >
+	bool readArray( Func func ) {
+		if( peek() != Token::StartArray ) {
+			skip();
+			return false;
+		}
+		next();
+
+		while( peek() != Token::EndArray && ok() ) {
+			const size_t position = m_position;
+			func();
+			if( m_position == position )
+				skip();
+		}
+
+		if( !ok() )
+			return false;
+		next();
+		return true;
+	}
+
+	// Each consumes the value, out is left alone when the type doesn't match
+	void read( bool& out );
+	void read( float& out );
+	void read( int& out );
+	void read( size_t& out );
+	void read( string& out );
+
+	// Copies the value at the cursor into the arena, for parts still read from a DOM
+	void readValue( rapidjson::Value& out );
+	rapidjson::MemoryPoolAllocator<>& getArena() { return m_arena; }
+
+private:
+	struct Handler;
+
+private:
+	vector< char > m_buffer;
+	rapidjson::StringStream m_input{ "" };
+	rapidjson::Reader m_reader;
+	rapidjson::MemoryPoolAllocator<> m_arena;
+
+	// Current token
+	Token m_token{ Token::None };
+	bool m_bool{ false };
+	bool m_integer{ false };
+	int64_t m_int{ 0 };
+	double m_number{ 0.0 };
+	string m_string;
+
+	// Tokens consumed so far
+	size_t m_position{ 0u };
+};
 
 //--------------------------------------------------------------------------------
 
@@ -53,6 +175,21 @@ void getValue( const rapidjson::Value& value, Math::Color& out );
 
 //--------------------------------------------------------------------------------
 
+void getValue( Stream& value, Math::ValueSet< int >& out );
+void getValue( Stream& value, Math::ValueSet< float >& out );
+void getValue( Stream& value, Math::ValueSet< Math::Vec2 >& out );
+void getValue( Stream& value, Math::ValueSet< Math::Color >& out );
+
+void getValue( Stream& value, bool& out );
+void getValue( Stream& value, float& out );
+void getValue( Stream& value, int& out );
+void getValue( Stream& value, size_t& out );
+void getValue( Stream& value, string& out );
+void getValue( Stream& value, Math::Vec2& out );
+void getValue( Stream& value, Math::Color& out );
+
+//--------------------------------------------------------------------------------
+
 }
 
 //================================================================================
\ No newline at end of file
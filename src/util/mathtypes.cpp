@@ -549,6 +549,45 @@ void processSet( Math::ValueSet< Math::Color >& set ) {
 		set.value = set.min;
 }
 
+//--------------------------------------------------------------------------------
+
+// Flips the sign of each value with a coin toss, 32 tosses per draw
+template< class T >
+void invert( std::span< T > out ) {
+	uint32_t bits = 0u;
+	for( size_t i = 0u; i < out.size(); ++i ) {
+		if( i % 32u == 0u )
+			bits = Random::getStream().next();
+		if( bits & 1u )
+			out[ i ] = -out[ i ];
+		bits >>= 1;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void processSet( const Math::ValueSet< int >& set, std::span< int > out ) {
+	if( set.random )
+		Random::fillInts( out, set.min, set.max );
+	else
+		std::fill( out.begin(), out.end(), set.min );
+
+	if( set.inverse )
+		invert( out );
+}
+
+//--------------------------------------------------------------------------------
+
+void processSet( const Math::ValueSet< float >& set, std::span< float > out ) {
+	if( set.random )
+		Random::fillFloats( out, set.min, set.max );
+	else
+		std::fill( out.begin(), out.end(), set.min );
+
+	if( set.inverse )
+		invert( out );
+}
+
 //================================================================================
 
 Math::Vec2 ValueVelocity::process() {
@@ -571,6 +610,16 @@ void ValueVelocity::setValue( const rapidjson::Value& v ) {
 	if( v.HasMember( "value" ) )
 		json::getValue( v["value"], value );
 }
+
+//--------------------------------------------------------------------------------
+
+void ValueVelocity::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "value" )
+			json::getValue( in, value );
+	} );
+}
+
 //--------------------------------------------------------------------------------
 
 bool ValueVelocity::render() {
@@ -614,6 +663,17 @@ void AngleVelocity::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void AngleVelocity::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "angle" )
+			json::getValue( in, angle );
+		else if( key == "power" )
+			json::getValue( in, power );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool AngleVelocity::render() {
 	bool out = false;
 	ImGui::PushID( "AngleVelocity" );
@@ -657,6 +717,17 @@ void PointVelocity::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void PointVelocity::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "target" )
+			json::getValue( in, target );
+		else if( key == "power" )
+			json::getValue( in, power );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool PointVelocity::render() {
 	bool out = false;
 	ImGui::PushID( "PointVelocity" );
@@ -725,6 +796,40 @@ void Velocity::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void Velocity::setValue( json::Stream& in ) {
+	// "value" can only be read once the type is known, keep it as a DOM otherwise
+	bool typed = false;
+	rapidjson::Value stash;
+	in.readObject( [this, &in, &typed, &stash]( std::string_view key ) {
+		if( key == "type" ) {
+			int t = ( int ) type;
+			json::getValue( in, t );
+			type  = ( Type ) t;
+			typed = true;
+		}
+		else if( key == "value" && !typed )
+			in.readValue( stash );
+		else if( key == "value" ) {
+			switch( type ) {
+				case Type::ByValue: value.value.setValue( in ); break;
+				case Type::ByPoint: value.point.setValue( in ); break;
+				case Type::ByAngle: value.angle.setValue( in ); break;
+			}
+		}
+	} );
+
+	if( stash.IsNull() )
+		return;
+
+	switch( type ) {
+		case Type::ByValue: value.value.setValue( stash ); break;
+		case Type::ByPoint: value.point.setValue( stash ); break;
+		case Type::ByAngle: value.angle.setValue( stash ); break;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 bool Velocity::render( const char* id ) {
 	bool out = false;
 	ImGui::PushID( id );
@@ -778,6 +883,15 @@ void PointPosition::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void PointPosition::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "value" )
+			json::getValue( in, position );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool PointPosition::render() {
 	bool out = false;
 	ImGui::PushID( "PointPosition" );
@@ -835,6 +949,23 @@ void CirclePosition::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void CirclePosition::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "minRadius" )
+			json::getValue( in, minRadius );
+		else if( key == "maxRadius" )
+			json::getValue( in, maxRadius );
+		else if( key == "minAngle" )
+			json::getValue( in, minAngle );
+		else if( key == "maxAngle" )
+			json::getValue( in, maxAngle );
+		else if( key == "center" )
+			json::getValue( in, center );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool CirclePosition::render() {
 	bool out = false;
 	ImGui::PushID( "CirclePosition" );
@@ -893,6 +1024,21 @@ void UniformCirclePosition::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void UniformCirclePosition::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "radius" )
+			json::getValue( in, radius );
+		else if( key == "minAngle" )
+			json::getValue( in, minAngle );
+		else if( key == "maxAngle" )
+			json::getValue( in, maxAngle );
+		else if( key == "center" )
+			json::getValue( in, center );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool UniformCirclePosition::render() {
 	bool out = false;
 	ImGui::PushID( "UniformCirclePosition" );
@@ -946,6 +1092,19 @@ void SquarePosition::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void SquarePosition::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "minSize" )
+			json::getValue( in, minSize );
+		else if( key == "maxSize" )
+			json::getValue( in, maxSize );
+		else if( key == "center" )
+			json::getValue( in, center );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool SquarePosition::render() {
 	bool out = false;
 	ImGui::PushID( "SquarePosition" );
@@ -1029,6 +1188,19 @@ void UniformSquarePosition::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void UniformSquarePosition::setValue( json::Stream& in ) {
+	in.readObject( [this, &in]( std::string_view key ) {
+		if( key == "size" )
+			json::getValue( in, size );
+		else if( key == "center" )
+			json::getValue( in, center );
+		else if( key == "proportional" )
+			json::getValue( in, proportional );
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
 bool UniformSquarePosition::render() {
 	bool out = false;
 	ImGui::PushID( "UniformSquarePosition" );
@@ -1107,6 +1279,44 @@ void Position::setValue( const rapidjson::Value& v ) {
 
 //--------------------------------------------------------------------------------
 
+void Position::setValue( json::Stream& in ) {
+	// "value" can only be read once the type is known, keep it as a DOM otherwise
+	bool typed = false;
+	rapidjson::Value stash;
+	in.readObject( [this, &in, &typed, &stash]( std::string_view key ) {
+		if( key == "type" ) {
+			int t = ( int ) type;
+			json::getValue( in, t );
+			type  = ( Type ) t;
+			typed = true;
+		}
+		else if( key == "value" && !typed )
+			in.readValue( stash );
+		else if( key == "value" ) {
+			switch( type ) {
+				case Type::Point: value.point.setValue( in ); break;
+				case Type::Circle: value.circle.setValue( in ); break;
+				case Type::UniformCircle: value.uniformCircle.setValue( in ); break;
+				case Type::Square: value.square.setValue( in ); break;
+				case Type::UniformSquare: value.uniformSquare.setValue( in ); break;
+			}
+		}
+	} );
+
+	if( stash.IsNull() )
+		return;
+
+	switch( type ) {
+		case Type::Point: value.point.setValue( stash ); break;
+		case Type::Circle: value.circle.setValue( stash ); break;
+		case Type::UniformCircle: value.uniformCircle.setValue( stash ); break;
+		case Type::Square: value.square.setValue( stash ); break;
+		case Type::UniformSquare: value.uniformSquare.setValue( stash ); break;
+	}
+}
+
+//--------------------------------------------------------------------------------
+
 bool Position::render() {
 	bool out = false;
 	ImGui::PushID( "Position" );
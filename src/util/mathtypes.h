@@ -7,10 +7,17 @@
 #include "global.h"
 
 #include <cmath>
+#include <span>
 #include <rapidjson/document.h>
 
 //================================================================================
 
+namespace json {
+class Stream;
+}
+
+//================================================================================
+
 namespace Math {
 
 //================================================================================
@@ -157,6 +164,17 @@ void processSet( Math::ValueSet< float >& set );
 void processSet( Math::ValueSet< Math::Vec2 >& set );
 void processSet( Math::ValueSet< Math::Color >& set );
 
+// Rolls a copy, leaving the set untouched
+template< class T >
+T rollSet( Math::ValueSet< T > set ) {
+	processSet( set );
+	return set.value;
+}
+
+// One value per element of out, drawn in bulk
+void processSet( const Math::ValueSet< int >& set, std::span< int > out );
+void processSet( const Math::ValueSet< float >& set, std::span< float > out );
+
 //================================================================================
 
 template< class T >
@@ -172,6 +190,7 @@ struct ValueVelocity {
 	Math::Vec2 process();
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -184,6 +203,7 @@ struct AngleVelocity {
 	Math::Vec2 process();
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -196,6 +216,7 @@ struct PointVelocity {
 	Math::Vec2 process( Math::Vec2 position );
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -217,6 +238,7 @@ struct Velocity {
 	Math::Vec2 process( Math::Vec2 position = Math::Vec2() );
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render( const char* id );
 };
 
@@ -227,6 +249,7 @@ struct PointPosition {
 
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -242,6 +265,7 @@ struct CirclePosition {
 	Math::Vec2 process();
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -256,6 +280,7 @@ struct UniformCirclePosition {
 	Math::Vec2 process( int index, int total );
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -269,6 +294,7 @@ struct SquarePosition {
 	Math::Vec2 process();
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -282,6 +308,7 @@ struct UniformSquarePosition {
 	Math::Vec2 process( int index, int total );
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -307,6 +334,7 @@ struct Position {
 	Math::Vec2 process( int index = 0, int total = 0 );
 	rapidjson::Value getValue();
 	void setValue( const rapidjson::Value& v );
+	void setValue( json::Stream& in );
 	bool render();
 };
 
@@ -4,7 +4,9 @@
 
 //--------------------------------------------------------------------------------
 
-#include <cstdlib>
+#include <atomic>
+
+#include "jobs.h"
 
 //================================================================================
 
@@ -12,19 +14,193 @@ namespace Random {
 
 //--------------------------------------------------------------------------------
 
-int seed{ 0 };
+// Ids above this are thread streams, below are free for makeStream
+constexpr uint64_t threadStreams = uint64_t( 1u ) << 63;
+
+// Lanes per step of the bulk fills
+constexpr size_t lanes = 8u;
+
+std::atomic< uint64_t > seed{ 0u };
+// Bumped by setSeed so thread streams know to reseed
+std::atomic< uint32_t > epoch{ 0u };
+
+thread_local Stream threadStream;
+thread_local uint32_t threadEpoch{ std::numeric_limits< uint32_t >::max() };
+thread_local Stream* current{ nullptr };
+
+//--------------------------------------------------------------------------------
+
+uint32_t rotl( uint32_t x, int k ) {
+	return ( x << k ) | ( x >> ( 32 - k ) );
+}
+
+uint64_t splitMix( uint64_t& state ) {
+	uint64_t z = ( state += 0x9e3779b97f4a7c15ull );
+	z		   = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+	z		   = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+	return z ^ ( z >> 31 );
+}
+
+// Top 24 bits to [0, 1), exact in a float
+float toUnit( uint32_t x ) {
+	return float( x >> 8 ) * 0x1.0p-24f;
+}
 
 //================================================================================
 
-int getInt( int min, int max ) {
+Stream::Stream( uint64_t seed, uint64_t id ) {
+	uint64_t state = seed ^ splitMix( id );
+
+	const uint64_t a = splitMix( state );
+	const uint64_t b = splitMix( state );
+	m_state[ 0 ]	 = uint32_t( a );
+	m_state[ 1 ]	 = uint32_t( a >> 32 );
+	m_state[ 2 ]	 = uint32_t( b );
+	m_state[ 3 ]	 = uint32_t( b >> 32 );
+}
+
+//--------------------------------------------------------------------------------
+
+uint32_t Stream::next() {
+	const uint32_t out = rotl( m_state[ 1 ] * 5u, 7 ) * 9u;
+	const uint32_t t   = m_state[ 1 ] << 9;
+
+	m_state[ 2 ] ^= m_state[ 0 ];
+	m_state[ 3 ] ^= m_state[ 1 ];
+	m_state[ 1 ] ^= m_state[ 2 ];
+	m_state[ 0 ] ^= m_state[ 3 ];
+	m_state[ 2 ] ^= t;
+	m_state[ 3 ] = rotl( m_state[ 3 ], 11 );
+
+	return out;
+}
+
+//--------------------------------------------------------------------------------
+
+int Stream::nextInt( int min, int max ) {
 	if( min == max )
 		return min;
+	if( max < min )
+		std::swap( min, max );
 
-	int out = rand();
-	out %= ( max - min );
-	out += min;
+	// Multiply-shift, no modulo bias for ranges this small
+	const uint64_t range = uint64_t( int64_t( max ) - int64_t( min ) );
+	return int( int64_t( min ) + int64_t( ( uint64_t( next() ) * range ) >> 32 ) );
+}
 
-	return out;
+//--------------------------------------------------------------------------------
+
+float Stream::nextFloat() {
+	return toUnit( next() );
+}
+
+//--------------------------------------------------------------------------------
+
+// xoshiro128+ over independent lanes, each seeded from the stream
+template< class Write >
+void fillLanes( Stream& stream, size_t size, Write write ) {
+	uint32_t s0[ lanes ], s1[ lanes ], s2[ lanes ], s3[ lanes ];
+
+	uint64_t state = ( uint64_t( stream.next() ) << 32 ) | stream.next();
+	for( size_t l = 0u; l < lanes; ++l ) {
+		const uint64_t a = splitMix( state );
+		const uint64_t b = splitMix( state );
+		s0[ l ]			 = uint32_t( a );
+		s1[ l ]			 = uint32_t( a >> 32 );
+		s2[ l ]			 = uint32_t( b );
+		s3[ l ]			 = uint32_t( b >> 32 );
+	}
+
+	uint32_t values[ lanes ];
+	for( size_t i = 0u; i < size; i += lanes ) {
+		for( size_t l = 0u; l < lanes; ++l ) {
+			values[ l ]		 = s0[ l ] + s3[ l ];
+			const uint32_t t = s1[ l ] << 9;
+
+			s2[ l ] ^= s0[ l ];
+			s3[ l ] ^= s1[ l ];
+			s1[ l ] ^= s2[ l ];
+			s0[ l ] ^= s3[ l ];
+			s2[ l ] ^= t;
+			s3[ l ] = rotl( s3[ l ], 11 );
+		}
+
+		write( i, std::min( lanes, size - i ), values );
+	}
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::fillFloats( std::span< float > out, float min, float max ) {
+	if( min == max ) {
+		std::fill( out.begin(), out.end(), min );
+		return;
+	}
+
+	const float range = max - min;
+	fillLanes( *this, out.size(), [&out, min, range]( size_t first, size_t count, const uint32_t* values ) {
+		for( size_t l = 0u; l < count; ++l )
+			out[ first + l ] = min + toUnit( values[ l ] ) * range;
+	} );
+}
+
+//--------------------------------------------------------------------------------
+
+void Stream::fillInts( std::span< int > out, int min, int max ) {
+	if( min == max ) {
+		std::fill( out.begin(), out.end(), min );
+		return;
+	}
+	if( max < min )
+		std::swap( min, max );
+
+	const uint64_t range = uint64_t( int64_t( max ) - int64_t( min ) );
+	fillLanes( *this, out.size(), [&out, min, range]( size_t first, size_t count, const uint32_t* values ) {
+		for( size_t l = 0u; l < count; ++l )
+			out[ first + l ] = int( int64_t( min ) + int64_t( ( uint64_t( values[ l ] ) * range ) >> 32 ) );
+	} );
+}
+
+//================================================================================
+
+Stream& getStream() {
+	if( current != nullptr )
+		return *current;
+
+	const uint32_t now = epoch.load( std::memory_order_acquire );
+	if( threadEpoch != now ) {
+		threadStream = Stream( seed.load( std::memory_order_relaxed ), threadStreams + Jobs::getThreadIndex() );
+		threadEpoch	 = now;
+	}
+
+	return threadStream;
+}
+
+//--------------------------------------------------------------------------------
+
+Stream makeStream( uint64_t id ) {
+	return Stream( seed.load( std::memory_order_relaxed ), id );
+}
+
+//--------------------------------------------------------------------------------
+
+ScopedStream::ScopedStream( Stream& stream ) : m_previous( current ) {
+	current = &stream;
+}
+
+//--------------------------------------------------------------------------------
+
+ScopedStream::~ScopedStream() {
+	current = m_previous;
+}
+
+//================================================================================
+
+int getInt( int min, int max ) {
+	if( min == max )
+		return min;
+
+	return getStream().nextInt( min, max );
 }
 
 //--------------------------------------------------------------------------------
@@ -68,11 +244,7 @@ float getFloat( float min, float max ) {
 	if( min == max )
 		return min;
 
-	float out = static_cast< float >( rand() );
-	out /= static_cast< float >( RAND_MAX ) / ( max - min );
-	out += min;
-
-	return out;
+	return min + getStream().nextFloat() * ( max - min );
 }
 
 //--------------------------------------------------------------------------------
@@ -112,6 +284,18 @@ RandomNumbers< float >
 
 //--------------------------------------------------------------------------------
 
+void fillFloats( std::span< float > out, float min, float max ) {
+	getStream().fillFloats( out, min, max );
+}
+
+//--------------------------------------------------------------------------------
+
+void fillInts( std::span< int > out, int min, int max ) {
+	getStream().fillInts( out, min, max );
+}
+
+//--------------------------------------------------------------------------------
+
 Math::Vec2 getVec2( Math::Vec2 min, Math::Vec2 max ) {
 	if( min == max )
 		return min;
@@ -213,21 +397,20 @@ RandomNumbers< Math::Color >
 //--------------------------------------------------------------------------------
 
 bool getBool() {
-	int out = rand();
-	return out % 2;
+	return getStream().next() >> 31;
 }
 
 //--------------------------------------------------------------------------------
 
-uint16_t getSeed() {
-	return seed;
+uint64_t getSeed() {
+	return seed.load( std::memory_order_relaxed );
 }
 
 //--------------------------------------------------------------------------------
 
-void setSeed( uint16_t number ) {
-	seed = number;
-	srand( seed );
+void setSeed( uint64_t number ) {
+	seed.store( number, std::memory_order_relaxed );
+	epoch.fetch_add( 1u, std::memory_order_release );
 }
 
 //--------------------------------------------------------------------------------
@@ -8,6 +8,8 @@
 
 #include "mathtypes.h"
 
+#include <span>
+
 //================================================================================
 
 namespace Random {
@@ -25,6 +27,55 @@ public:
 
 //================================================================================
 
+// xoshiro128** generator. The same seed and id always give the same sequence,
+// and streams with different ids are independent of each other.
+class Stream {
+public:
+	Stream() : Stream( 0u, 0u ) {}
+	Stream( uint64_t seed, uint64_t id );
+
+public:
+	uint32_t next();
+
+	// [min, max)
+	int nextInt( int min, int max );
+	// [0, 1)
+	float nextFloat();
+
+	// Bulk versions, [min, max). The stream only seeds a set of interleaved
+	// lanes, so the inner loop has no dependency between values and vectorises.
+	void fillFloats( std::span< float > out, float min, float max );
+	void fillInts( std::span< int > out, int min, int max );
+
+private:
+	uint32_t m_state[ 4 ];
+};
+
+//--------------------------------------------------------------------------------
+
+// Stream the free functions draw from on this thread. Defaults to one per
+// thread, derived from the seed and the job system thread index.
+Stream& getStream();
+
+// Stream for one owner, like a particle system, derived from the seed and id
+Stream makeStream( uint64_t id );
+
+// Redirects the free functions on this thread to stream until destroyed.
+// Used to make results independent of which thread runs the work.
+class ScopedStream {
+public:
+	ScopedStream( Stream& stream );
+	~ScopedStream();
+
+	ScopedStream( const ScopedStream& )			   = delete;
+	ScopedStream& operator=( const ScopedStream& ) = delete;
+
+private:
+	Stream* m_previous;
+};
+
+//================================================================================
+
 int getInt( int min, int max );
 int getInt( int min, int max, function< int( int randomNumber ) > func );
 RandomNumbers< int > getInt( int min, int max, size_t count );
@@ -35,6 +86,9 @@ float getFloat( float min, float max, function< float( float randomNumber ) > fu
 RandomNumbers< float > getFloat( float min, float max, size_t count );
 RandomNumbers< float > getFloat( float min, float max, size_t count, function< float( float randomNumber ) > func );
 
+void fillFloats( std::span< float > out, float min, float max );
+void fillInts( std::span< int > out, int min, int max );
+
 bool getBool();
 
 Math::Vec2 getVec2( Math::Vec2 min, Math::Vec2 max );
@@ -49,11 +103,12 @@ T getElement( const vector< T >& vec ) {
 
 //--------------------------------------------------------------------------------
 
-uint16_t getSeed();
-void setSeed( uint16_t seed );
+uint64_t getSeed();
+// Reseeds every thread stream, streams already made keep their sequence
+void setSeed( uint64_t seed );
 
 //--------------------------------------------------------------------------------
 
 } // Random
 
-//================================================================================
\ No newline at end of file
+//================================================================================
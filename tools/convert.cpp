@@ -0,0 +1,56 @@
+//================================================================================
+
+// Pattern converter
+// Writes the binary next to each JSON pattern, see Particle::Loader.
+// Usage: turbine-convert <pattern file or folder>...
+
+//================================================================================
+
+#include "global.h"
+
+#include <filesystem>
+
+#include "particle-affector-manager.h"
+#include "particle-loader.h"
+
+//================================================================================
+
+using namespace Gfx::Particle;
+
+//--------------------------------------------------------------------------------
+
+bool convertFile( const std::filesystem::path& path ) {
+	const bool out = Loader::convert( path.string() );
+	std::cout << ( out ? "Converted " : "Failed " ) << path.string() << "\n";
+	return out;
+}
+
+//================================================================================
+
+int main( int argc, char** argv ) {
+	if( argc < 2 ) {
+		std::cout << "Usage: turbine-convert <pattern file or folder>...\n";
+		return 1;
+	}
+
+	// Affector factories, looked up by name while reading
+	Affector::init();
+
+	int failed = 0;
+	for( int i = 1; i < argc; ++i ) {
+		const std::filesystem::path path( argv[ i ] );
+
+		if( !std::filesystem::is_directory( path ) ) {
+			failed += !convertFile( path );
+			continue;
+		}
+
+		for( const auto& entry : std::filesystem::recursive_directory_iterator( path ) )
+			if( entry.is_regular_file() && entry.path().extension() == ".bullet" )
+				failed += !convertFile( entry.path() );
+	}
+
+	return failed == 0 ? 0 : 1;
+}
+
+//================================================================================